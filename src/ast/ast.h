@@ -1,24 +1,39 @@
 #pragma once
 
-#include <string>
-#include <vector>
-#include <memory.h>
 #include <optional>
-#include <memory>
+#include <string_view>
+#include <tuple>
+
+#include "../utilities/arena/arena.h"
+#include "../utilities/interner/string_interner.h"
 
 enum BinaryOperator {
     SUB = 0,
     DIV,
     ADD,
-    MUL
+    MUL,
+    AND,
+    OR,
+    LT,
+    GT,
+    LTE,
+    GTE,
+    EQ,
+    NEQ
+};
+
+enum UnaryOperator {
+    NEG = 0
 };
 
 class IVisitor {
 public:
     virtual void visit(class IntegerNode& node) = 0;
     virtual void visit(class FloatNode& node) = 0;
+    virtual void visit(class BooleanNode& node) = 0;
     virtual void visit(class IdentifierNode& node) = 0;
     virtual void visit(class BinaryOperationNode& node) = 0;
+    virtual void visit(class UnaryOperationNode& node) = 0;
     virtual void visit(class VarDefNode& node) = 0;
     virtual void visit(class ReturnNode& node) = 0;
     virtual void visit(class BlockNode& node) = 0;
@@ -26,10 +41,14 @@ public:
     virtual void visit(class CallNode& node) = 0;
 };
 
+// Nodes are allocated in an Arena and released with it, never one by one,
+// so they are trivially destructible: children are plain pointers or spans
+// and names are interned Symbols.
 class INode {
 public:
     virtual void accept(IVisitor& visitor) = 0;
-    virtual ~INode() {};
+protected:
+    ~INode() = default;
 };
 
 class IntegerNode : public INode {
@@ -56,12 +75,24 @@ public:
     }
 };
 
+class BooleanNode : public INode {
+    bool _value;
+public:
+    BooleanNode(bool val) : _value(val) {}
+
+    bool getValue() const { return _value; }
+
+    void accept(IVisitor& visitor) override {
+        visitor.visit(*this);
+    }
+};
+
 class IdentifierNode : public INode {
-    std::string _name;
+    Symbol _name;
 public:
-    IdentifierNode(std::string name): _name(name) {}
+    IdentifierNode(Symbol name): _name(name) {}
 
-    std::string getName() const { return _name; }
+    Symbol getName() const { return _name; }
 
     void accept(IVisitor& visitor) override {
         visitor.visit(*this);
@@ -69,14 +100,14 @@ public:
 };
 
 class BinaryOperationNode : public INode {
-    std::shared_ptr<INode> _lhs;
-    std::shared_ptr<INode> _rhs;
+    INode* _lhs;
+    INode* _rhs;
     BinaryOperator _op;
 public:
-    BinaryOperationNode(std::shared_ptr<INode> lhs, std::shared_ptr<INode> rhs, BinaryOperator op): _lhs(lhs), _rhs(rhs), _op(op) {}
+    BinaryOperationNode(INode* lhs, INode* rhs, BinaryOperator op): _lhs(lhs), _rhs(rhs), _op(op) {}
 
-    INode& getLhs() const { return *_lhs.get(); }
-    INode& getRhs() const { return *_rhs.get(); }
+    INode& getLhs() const { return *_lhs; }
+    INode& getRhs() const { return *_rhs; }
 
     BinaryOperator getOp() const { return _op; }
 
@@ -85,15 +116,30 @@ public:
     }
 };
 
+class UnaryOperationNode : public INode {
+    INode* _operand;
+    UnaryOperator _op;
+public:
+    UnaryOperationNode(INode* operand, UnaryOperator op): _operand(operand), _op(op) {}
+
+    INode& getOperand() const { return *_operand; }
+
+    UnaryOperator getOp() const { return _op; }
+
+    void accept(IVisitor& visitor) override {
+        visitor.visit(*this);
+    }
+};
+
 class VarDefNode : public INode {
-    std::string _name;
-    std::shared_ptr<INode> _content;
+    Symbol _name;
+    INode* _content;
 public:
-    VarDefNode(std::string name, std::shared_ptr<INode> content): _name(name), _content(content) {}
+    VarDefNode(Symbol name, INode* content): _name(name), _content(content) {}
 
-    INode& getContent() const { return *_content.get(); }
+    INode& getContent() const { return *_content; }
 
-    const std::string& getName() const { return _name; }
+    Symbol getName() const { return _name; }
 
     void accept(IVisitor& visitor) override {
         visitor.visit(*this);
@@ -101,10 +147,11 @@ public:
 };
 
 class ReturnNode : public INode {
-    std::optional<std::shared_ptr<INode>> _retData;
+    INode* _retData;
 
 public:
-    explicit ReturnNode(std::optional<std::shared_ptr<INode>> data)
+    // data is null for a bare "ret;".
+    explicit ReturnNode(INode* data)
         : _retData(data) {}
 
     void accept(IVisitor& visitor) override {
@@ -112,76 +159,75 @@ public:
     }
 
     std::optional<INode*> getRetData() const {
-        if (_retData && _retData.value()) {
-            return _retData.value().get();
+        if (_retData) {
+            return _retData;
         }
         return std::nullopt;
     }
 };
 
 class BlockNode : public INode {
-    std::vector<std::shared_ptr<INode>> _nodes;
+    Span<INode*> _nodes;
 public:
-    BlockNode(std::vector<std::shared_ptr<INode>>& nodes): _nodes(nodes) {}
+    BlockNode(Span<INode*> nodes): _nodes(nodes) {}
 
     void accept(IVisitor& visitor) override {
         visitor.visit(*this);
     }
 
-    const std::vector<std::shared_ptr<INode>>& getNodes() const {
+    Span<INode*> getNodes() const {
         return _nodes;
     }
 };
 
 class FunctionNode : public INode {
-    std::string _name;
-    std::string _retType; //replace with tokens
-    std::string _visibility; //replace with tokens
-    std::vector<std::tuple<std::string, std::string>> _args; //replace with tokens
-    std::shared_ptr<BlockNode> _body;
+    Symbol _name;
+    Symbol _retType; //replace with tokens
+    std::string_view _visibility; //replace with tokens
+    Span<std::tuple<Symbol, Symbol>> _args; //replace with tokens
+    BlockNode* _body;
 public:
     FunctionNode(
-        std::string name, 
-        std::string retType, 
-        std::string visibility, 
-        std::vector<std::tuple<std::string, 
-        std::string>> args, 
-        std::shared_ptr<BlockNode> body)
+        Symbol name, 
+        Symbol retType, 
+        std::string_view visibility, 
+        Span<std::tuple<Symbol, Symbol>> args, 
+        BlockNode* body)
         : _name(name), _retType(retType), _visibility(visibility), _args(args), _body(body) {}
     
     void accept(IVisitor& visitor) override {
         visitor.visit(*this);
     }
 
-    const std::string& getName() const { return _name; }
+    Symbol getName() const { return _name; }
 
-    const std::string& getReturnType() const { return _retType; }
+    Symbol getReturnType() const { return _retType; }
 
-    const std::string& getVisibility() const { return _visibility; }
+    std::string_view getVisibility() const { return _visibility; }
 
-    const std::vector<std::tuple<std::string, std::string>>& getArgs() const { return _args; }
+    Span<std::tuple<Symbol, Symbol>> getArgs() const { return _args; }
 
-    BlockNode& getBody() const { return *_body.get(); }
+    BlockNode& getBody() const { return *_body; }
 };
 
-class CallNode : INode {
-    std::optional<std::string> _alias;
-    std::string _name;
-    std::vector<std::shared_ptr<INode>> _args;
+class CallNode : public INode {
+    std::optional<Symbol> _alias;
+    Symbol _name;
+    Span<INode*> _args;
 public: 
     CallNode(
-        std::optional<std::string> alias, 
-        std::string name, 
-        std::vector<std::shared_ptr<INode>> args) 
+        std::optional<Symbol> alias, 
+        Symbol name, 
+        Span<INode*> args) 
         : _alias(alias), _name(name), _args(args) {}
 
     void accept(IVisitor& visitor) override {
         visitor.visit(*this);
     }
 
-    const std::optional<std::string>& getAlias() const { return _alias; }
+    const std::optional<Symbol>& getAlias() const { return _alias; }
 
-    const std::string& getName() const { return _name; }
+    Symbol getName() const { return _name; }
 
-    const std::vector<std::shared_ptr<INode>>& getArgs() const { return _args; }
+    Span<INode*> getArgs() const { return _args; }
 };
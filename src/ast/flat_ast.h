@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ast.h"
+
+enum class FlatKind : uint8_t {
+    INTEGER,
+    FLOAT,
+    BOOLEAN,
+    IDENTIFIER,
+    BINARY_OPERATION,
+    VAR_DEF,
+    RETURN,
+    BLOCK,
+    FUNCTION,
+    CALL,
+    UNARY_OPERATION
+};
+
+using FlatIndex = uint32_t;
+
+static constexpr FlatIndex noFlatNode = UINT32_MAX;
+
+// The AST as parallel arrays: one kind byte and three 32-bit operands per
+// node, with children referenced by index. Variable-length child lists live
+// in a shared index pool. Walking it is a switch over kind() on contiguous
+// memory instead of a virtual call per node.
+//
+// Operands by kind:
+//   INTEGER, FLOAT, BOOLEAN  value bits
+//   IDENTIFIER               name symbol
+//   BINARY_OPERATION         lhs, rhs, BinaryOperator
+//   UNARY_OPERATION          operand, UnaryOperator
+//   VAR_DEF                  name symbol, content
+//   RETURN                   value or noFlatNode
+//   BLOCK                    pool start, statement count
+//   CALL                     name symbol, pool start, argument count;
+//                            the pool holds the alias symbol, then the args
+//   FUNCTION                 name symbol, body, pool start; the pool holds
+//                            the return type, 1 if public, the parameter
+//                            count, then a name and type symbol per parameter
+class FlatAst {
+    std::vector<FlatKind> _kinds;
+    std::vector<uint32_t> _first;
+    std::vector<uint32_t> _second;
+    std::vector<uint32_t> _third;
+    std::vector<uint32_t> _pool;
+    std::vector<FlatIndex> _functions;
+
+    FlatIndex add(FlatKind kind, uint32_t first, uint32_t second = 0, uint32_t third = 0) {
+        _kinds.push_back(kind);
+        _first.push_back(first);
+        _second.push_back(second);
+        _third.push_back(third);
+        return static_cast<FlatIndex>(_kinds.size() - 1);
+    }
+
+    static uint32_t bits(float value) {
+        uint32_t result;
+        memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+public:
+    void reserve(size_t nodes) {
+        _kinds.reserve(nodes);
+        _first.reserve(nodes);
+        _second.reserve(nodes);
+        _third.reserve(nodes);
+    }
+
+    FlatIndex addInteger(int value) { return add(FlatKind::INTEGER, static_cast<uint32_t>(value)); }
+    FlatIndex addFloat(float value) { return add(FlatKind::FLOAT, bits(value)); }
+    FlatIndex addBoolean(bool value) { return add(FlatKind::BOOLEAN, value); }
+    FlatIndex addIdentifier(Symbol name) { return add(FlatKind::IDENTIFIER, name.getId()); }
+    FlatIndex addBinaryOperation(FlatIndex lhs, FlatIndex rhs, BinaryOperator op) {
+        return add(FlatKind::BINARY_OPERATION, lhs, rhs, op);
+    }
+    FlatIndex addUnaryOperation(FlatIndex operand, UnaryOperator op) {
+        return add(FlatKind::UNARY_OPERATION, operand, op);
+    }
+    FlatIndex addVarDef(Symbol name, FlatIndex content) { return add(FlatKind::VAR_DEF, name.getId(), content); }
+    FlatIndex addReturn(FlatIndex value) { return add(FlatKind::RETURN, value); }
+
+    FlatIndex addBlock(const std::vector<FlatIndex>& statements) {
+        uint32_t start = static_cast<uint32_t>(_pool.size());
+        _pool.insert(_pool.end(), statements.begin(), statements.end());
+        return add(FlatKind::BLOCK, start, static_cast<uint32_t>(statements.size()));
+    }
+
+    FlatIndex addCall(Symbol alias, Symbol name, const std::vector<FlatIndex>& args) {
+        uint32_t start = static_cast<uint32_t>(_pool.size());
+        _pool.push_back(alias.getId());
+        _pool.insert(_pool.end(), args.begin(), args.end());
+        return add(FlatKind::CALL, name.getId(), start, static_cast<uint32_t>(args.size()));
+    }
+
+    FlatIndex addFunction(Symbol name, Symbol retType, bool isPublic,
+                          const std::vector<std::pair<Symbol, Symbol>>& params, FlatIndex body) {
+        uint32_t start = static_cast<uint32_t>(_pool.size());
+        _pool.push_back(retType.getId());
+        _pool.push_back(isPublic);
+        _pool.push_back(static_cast<uint32_t>(params.size()));
+        for (const auto& param : params) {
+            _pool.push_back(param.first.getId());
+            _pool.push_back(param.second.getId());
+        }
+        FlatIndex function = add(FlatKind::FUNCTION, name.getId(), body, start);
+        _functions.push_back(function);
+        return function;
+    }
+
+    size_t size() const { return _kinds.size(); }
+    const std::vector<FlatIndex>& functions() const { return _functions; }
+
+    FlatKind kind(FlatIndex node) const { return _kinds[node]; }
+
+    int intValue(FlatIndex node) const { return static_cast<int>(_first[node]); }
+    float floatValue(FlatIndex node) const {
+        float value;
+        memcpy(&value, &_first[node], sizeof(value));
+        return value;
+    }
+    bool boolValue(FlatIndex node) const { return _first[node] != 0; }
+
+    // IDENTIFIER, VAR_DEF, CALL and FUNCTION.
+    Symbol name(FlatIndex node) const { return Symbol(_first[node]); }
+
+    FlatIndex lhs(FlatIndex node) const { return _first[node]; }
+    FlatIndex rhs(FlatIndex node) const { return _second[node]; }
+    BinaryOperator op(FlatIndex node) const { return static_cast<BinaryOperator>(_third[node]); }
+
+    FlatIndex operand(FlatIndex node) const { return _first[node]; }
+    UnaryOperator unaryOp(FlatIndex node) const { return static_cast<UnaryOperator>(_second[node]); }
+
+    FlatIndex content(FlatIndex node) const { return _second[node]; }
+    FlatIndex returnValue(FlatIndex node) const { return _first[node]; }
+
+    Span<const FlatIndex> statements(FlatIndex node) const {
+        return Span<const FlatIndex>(_pool.data() + _first[node], _second[node]);
+    }
+
+    Symbol callAlias(FlatIndex node) const { return Symbol(_pool[_second[node]]); }
+    Span<const FlatIndex> callArgs(FlatIndex node) const {
+        return Span<const FlatIndex>(_pool.data() + _second[node] + 1, _third[node]);
+    }
+
+    FlatIndex body(FlatIndex node) const { return _second[node]; }
+    Symbol returnType(FlatIndex node) const { return Symbol(_pool[_third[node]]); }
+    bool isPublic(FlatIndex node) const { return _pool[_third[node] + 1] != 0; }
+    uint32_t paramCount(FlatIndex node) const { return _pool[_third[node] + 2]; }
+    Symbol paramName(FlatIndex node, uint32_t param) const { return Symbol(_pool[_third[node] + 3 + 2 * param]); }
+    Symbol paramType(FlatIndex node, uint32_t param) const { return Symbol(_pool[_third[node] + 4 + 2 * param]); }
+};
+
+// Copies pointer-based trees into a FlatAst, children before parents.
+class FlatAstBuilder : public IVisitor {
+    FlatAst& _ast;
+    FlatIndex _result;
+
+public:
+    explicit FlatAstBuilder(FlatAst& ast) : _ast(ast), _result(noFlatNode) {}
+
+    FlatIndex build(INode& node) {
+        node.accept(*this);
+        return _result;
+    }
+
+    void visit(IntegerNode& node) override { _result = _ast.addInteger(node.getValue()); }
+    void visit(FloatNode& node) override { _result = _ast.addFloat(node.getValue()); }
+    void visit(BooleanNode& node) override { _result = _ast.addBoolean(node.getValue()); }
+    void visit(IdentifierNode& node) override { _result = _ast.addIdentifier(node.getName()); }
+
+    void visit(BinaryOperationNode& node) override {
+        FlatIndex lhs = build(node.getLhs());
+        FlatIndex rhs = build(node.getRhs());
+        _result = _ast.addBinaryOperation(lhs, rhs, node.getOp());
+    }
+
+    void visit(UnaryOperationNode& node) override {
+        _result = _ast.addUnaryOperation(build(node.getOperand()), node.getOp());
+    }
+
+    void visit(VarDefNode& node) override { _result = _ast.addVarDef(node.getName(), build(node.getContent())); }
+
+    void visit(ReturnNode& node) override {
+        auto value = node.getRetData();
+        _result = _ast.addReturn(value ? build(**value) : noFlatNode);
+    }
+
+    void visit(BlockNode& node) override {
+        std::vector<FlatIndex> statements;
+        statements.reserve(node.getNodes().size());
+        for (INode* statement : node.getNodes()) {
+            statements.push_back(build(*statement));
+        }
+        _result = _ast.addBlock(statements);
+    }
+
+    void visit(FunctionNode& node) override {
+        std::vector<std::pair<Symbol, Symbol>> params;
+        for (const auto& arg : node.getArgs()) {
+            params.emplace_back(std::get<0>(arg), std::get<1>(arg));
+        }
+        FlatIndex body = build(node.getBody());
+        _result = _ast.addFunction(node.getName(), node.getReturnType(), node.getVisibility() == "public", params, body);
+    }
+
+    void visit(CallNode& node) override {
+        std::vector<FlatIndex> args;
+        for (INode* arg : node.getArgs()) {
+            args.push_back(build(*arg));
+        }
+        _result = _ast.addCall(node.getAlias().value_or(Symbol()), node.getName(), args);
+    }
+};
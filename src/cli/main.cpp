@@ -1,4 +1,7 @@
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
 #include "../utilities/logging/logger_manager/logger_manager.h"
 #include "../utilities/logging/console_logger/console_logger.h"
 #include "../utilities/logging/log_formatter/interface/ilog_formatter.h"
@@ -6,16 +9,72 @@
 #include "../utilities/logging/file_logger/file_logger.h"
 
 #include "../itt/ast_to_itt_translator/ast_to_itt_translator.h"
+#include "../itt/type_inference/type_inference.h"
+#include "../itt/constant_folding/constant_folding.h"
+#include "../itt/dead_code/dead_code.h"
+#include "../itt/pass_manager/pass_manager.h"
 #include "../codegen_llvm/codegen.h"
 
 #include "../lexer/lexer.h"
+#include "../parser/parser.h"
 
-int main() {
+int main(int argc, char** argv) {
     LoggerManager& loggerManager = LoggerManager::getInstance();
     std::shared_ptr<ILogger> consoleLogger = std::make_shared<ConsoleLogger>();
     std::shared_ptr<ILogFormatter> logFormatter = std::make_shared<DefaultFormatter>();
     loggerManager.addLogger(consoleLogger);
 
+    if (argc < 2) {
+        loggerManager.log(LogType::ERR, "Usage: comodotc <source file | -> [--time-passes]");
+        return 1;
+    }
+
+    try {
+        Lexer lexer = Lexer::fromFile(argv[1]);
+        TokenStream tokens = lexer.tokenizeAll();
+
+        for (const LexError& error : lexer.getErrors()) {
+            SourceLocation location = lexer.locate(error.offset);
+            loggerManager.log(LogType::ERR, std::to_string(location.row) + ":" + std::to_string(location.col) + ": " + error.message);
+        }
+        if (!lexer.getErrors().empty()) {
+            return 1;
+        }
+
+        Arena arena;
+        AstToIttTranslator translator(arena);
+        std::vector<IttFunctionNode*> program;
+        for (FunctionNode* function : Parser(tokens, arena).parseProgram()) {
+            program.push_back(static_cast<IttFunctionNode*>(translator.translate(*function)));
+        }
+
+        PassManager passes(std::thread::hardware_concurrency());
+        passes.addProgramPass("type inference", [](std::vector<IttFunctionNode*>& functions, IttAnalyses&, PassCounters&) {
+            TypeInference typeInference;
+            for (IttFunctionNode* function : functions) {
+                typeInference.declare(*function);
+            }
+            for (IttFunctionNode* function : functions) {
+                typeInference.run(*function);
+            }
+        }, PRESERVES_ALL);
+        passes.addFunctionPass<ConstantFolder>("constant folding");
+        passes.addFunctionPass<DeadCodeEliminator>("dead code");
+        passes.addProgramPass("prune", [](std::vector<IttFunctionNode*>& functions, IttAnalyses& analyses,
+                                          PassCounters& counters) {
+            addCounter(counters, "pruned functions", DeadCodeEliminator::prune(functions, analyses.reachable(functions)));
+        }, PRESERVES_SUMMARIES);
+        passes.run(program);
+
+        if (argc > 2 && std::string(argv[2]) == "--time-passes") {
+            std::ostringstream statistics;
+            passes.printStatistics(statistics);
+            loggerManager.log(LogType::INFO, statistics.str());
+        }
+    } catch (const std::runtime_error& error) {
+        loggerManager.log(LogType::ERR, error.what());
+        return 1;
+    }
 
     return 0;
 }
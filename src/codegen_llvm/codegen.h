@@ -7,9 +7,12 @@
 #include <llvm/IR/Type.h>
 
 #include "../itt/itt.h"
+#include "../itt/type_context.h"
 
 struct ModuleCodegenCtx {
-
+    // Where the module's compound types were interned; primitive types need
+    // no context.
+    const TypeContext* types = nullptr;
 };
 
 struct GlobalCodegenCtx {
@@ -24,11 +27,15 @@ class CodegenVisitor: public IttVisitor {
 
     llvm::Value* _generatedValue;
 
+    // Lowered types by IttType index, filled on first use.
+    std::vector<llvm::Type*> _llvmTypes;
+
     llvm::Value* getValue() { return _generatedValue; }
 
     void assignGeneratedValue(llvm::Value* value) { _generatedValue = value; }
 
     llvm::Type* getLLVMType(IttType type);
+    llvm::Type* lowerType(IttType type);
 
 public:
 
@@ -43,6 +50,7 @@ public:
     const std::unique_ptr<llvm::Module>& getBuildedModule() const { return _buildingModule; }
 
     void visit(IttBinaryOperationNode& node) override;
+    void visit(IttUnaryOperationNode& node) override;
     void visit(IttVariableNode& node) override;
     void visit(IttFunctionNode& node) override;
     void visit(IttBlockNode& node) override;
@@ -51,4 +59,5 @@ public:
     void visit(IttBooleanNode& node) override;
     void visit(IttCharNode& node) override;
     void visit(IttReturnNode& node) override;
+    void visit(IttCallNode& node) override;
 };
\ No newline at end of file
@@ -31,6 +31,24 @@ void CodegenVisitor::visit(IttBinaryOperationNode& node) {
         case IttBinaryOperation::EQUALS:
             result = _builder->CreateICmpEQ(lhs, rhs, "eqtmp");
             break;
+        case IttBinaryOperation::LESS_EQUALS:
+            result = _builder->CreateICmpSLE(lhs, rhs, "lesseqtmp");
+            break;
+        case IttBinaryOperation::GREATER_EQUALS:
+            result = _builder->CreateICmpSGE(lhs, rhs, "greatereqtmp");
+            break;
+        case IttBinaryOperation::NOT_EQUALS:
+            result = _builder->CreateICmpNE(lhs, rhs, "neqtmp");
+            break;
+        case IttBinaryOperation::AND:
+            result = _builder->CreateAnd(lhs, rhs, "andtmp");
+            break;
+        case IttBinaryOperation::OR:
+            result = _builder->CreateOr(lhs, rhs, "ortmp");
+            break;
+        case IttBinaryOperation::SHL:
+            result = _builder->CreateShl(lhs, rhs, "shltmp");
+            break;
         default:
             throw std::runtime_error("Unsupported binary operation");
     }
@@ -39,6 +57,25 @@ void CodegenVisitor::visit(IttBinaryOperationNode& node) {
 }
 
 
+void CodegenVisitor::visit(IttUnaryOperationNode& node) {
+    node.getOperand().accept(*this);
+    llvm::Value* operand = this->getValue();
+
+    llvm::Value* result = nullptr;
+    switch (node.getOperation()) {
+        case IttUnaryOperation::NEG:
+            // fneg flips the sign bit; fsub from 0.0 would lose -0.0.
+            if (node.getType().getKind() == IttType::FLOAT) {
+                result = _builder->CreateFNeg(operand, "negtmp");
+            } else {
+                result = _builder->CreateNeg(operand, "negtmp");
+            }
+            break;
+    }
+
+    this->assignGeneratedValue(result);
+}
+
 void CodegenVisitor::visit(IttVariableNode& node) {
 
 }
@@ -56,8 +93,8 @@ void CodegenVisitor::visit(IttFunctionNode& node) {
 
     llvm::Function* function = llvm::Function::Create(
         funcType,
-        llvm::Function::ExternalLinkage,
-        node.getName(),
+        node.getVisibility() == IttVisibility::PRIVATE ? llvm::Function::InternalLinkage : llvm::Function::ExternalLinkage,
+        llvm::StringRef(node.getName().str()),
         _buildingModule.get()
     );
 
@@ -72,7 +109,7 @@ void CodegenVisitor::visit(IttFunctionNode& node) {
 }
 
 void CodegenVisitor::visit(IttBlockNode& node) {
-    std::for_each(node.getStatements().begin(), node.getStatements().end(), [this](const std::unique_ptr<IttNode>& blockPart) {
+    std::for_each(node.getStatements().begin(), node.getStatements().end(), [this](IttNode* blockPart) {
         blockPart->accept(*this);
     });
 }
@@ -111,7 +148,7 @@ void CodegenVisitor::visit(IttCharNode& node) {
 
 void CodegenVisitor::visit(IttReturnNode& node) {
     if (node.getReturnStmt().has_value()) {
-        IttNode* returnContent = node.getReturnStmt()->get();
+        IttNode* returnContent = *node.getReturnStmt();
         returnContent->accept(*this);
 
         llvm::Value* returnValue = this->getValue();
@@ -122,12 +159,70 @@ void CodegenVisitor::visit(IttReturnNode& node) {
     }
 }
 
+void CodegenVisitor::visit(IttCallNode& node) {
+    llvm::Function* callee = _buildingModule->getFunction(llvm::StringRef(node.getCallee().str()));
+    if (!callee) {
+        throw std::runtime_error("Call to a function that is not generated yet: " + std::string(node.getCallee().str()));
+    }
+
+    std::vector<llvm::Value*> arguments;
+    for (IttNode* argument : node.getArguments()) {
+        argument->accept(*this);
+        arguments.push_back(this->getValue());
+    }
+
+    this->assignGeneratedValue(_builder->CreateCall(callee, arguments));
+}
+
 llvm::Type* CodegenVisitor::getLLVMType(IttType type) {
+    uint32_t index = type.getIndex();
+    if (index < _llvmTypes.size() && _llvmTypes[index]) {
+        return _llvmTypes[index];
+    }
+
+    // Lowering recurses into member types, which may grow the cache.
+    llvm::Type* lowered = lowerType(type);
+    if (index >= _llvmTypes.size()) {
+        _llvmTypes.resize(index + 1, nullptr);
+    }
+    _llvmTypes[index] = lowered;
+    return lowered;
+}
+
+llvm::Type* CodegenVisitor::lowerType(IttType type) {
     switch (type.getKind()) {
         case IttType::INT: return llvm::Type::getInt32Ty(_context);
         case IttType::FLOAT: return llvm::Type::getFloatTy(_context);
         case IttType::BOOL: return llvm::Type::getInt1Ty(_context);
         case IttType::CHAR: return llvm::Type::getInt8Ty(_context);
+        case IttType::VOID: return llvm::Type::getVoidTy(_context);
+        default: break;
+    }
+
+    if (!_genContex.types) {
+        throw std::runtime_error("Unsupported type");
+    }
+    const TypeContext& types = *_genContex.types;
+
+    switch (type.getKind()) {
+        case IttType::POINTER:
+            return llvm::PointerType::getUnqual(getLLVMType(types.pointee(type)));
+        case IttType::ARRAY:
+            return llvm::ArrayType::get(getLLVMType(types.element(type)), types.length(type));
+        case IttType::FUNCTION: {
+            std::vector<llvm::Type*> params;
+            for (IttType param : types.parameters(type)) {
+                params.push_back(getLLVMType(param));
+            }
+            return llvm::FunctionType::get(getLLVMType(types.returnType(type)), params, false);
+        }
+        case IttType::STRUCT: {
+            std::vector<llvm::Type*> fields;
+            for (IttType field : types.fields(type)) {
+                fields.push_back(getLLVMType(field));
+            }
+            return llvm::StructType::create(_context, fields, llvm::StringRef(types.structName(type).str()));
+        }
         default: throw std::runtime_error("Unsupported type");
     }
-}
\ No newline at end of file
+}
@@ -1,14 +1,14 @@
-#include <memory>
 #include <gtest/gtest.h>
 
 #include "ast_to_itt_translator.h"
 
 TEST(TranslatorTests, TestIdentifierTranslation) {
-    IdentifierNode identifier("var1");
-    AstToIttTranslator translator;
+    IdentifierNode identifier(Symbol::intern("var1"));
+    Arena arena;
+    AstToIttTranslator translator(arena);
     auto result = translator.translate(identifier);
     ASSERT_NE(result, nullptr);
-    auto* identifierNode = dynamic_cast<IttIdentifierNode*>(result.get());
+    auto* identifierNode = dynamic_cast<IttIdentifierNode*>(result);
     ASSERT_NE(identifierNode, nullptr);
     EXPECT_EQ(identifierNode->getName(), "var1");
     EXPECT_EQ(identifierNode->getType().getKind(), IttType::UNRESOLVED);
@@ -16,39 +16,42 @@ TEST(TranslatorTests, TestIdentifierTranslation) {
 
 TEST(TranslatorTests, TestIntegerTranslation) {
     IntegerNode i(5);
-    AstToIttTranslator translator;
+    Arena arena;
+    AstToIttTranslator translator(arena);
     auto result = translator.translate(i);
     ASSERT_NE(result, nullptr);
-    auto* intNode = dynamic_cast<IttIntegerNode*>(result.get());
+    auto* intNode = dynamic_cast<IttIntegerNode*>(result);
     ASSERT_NE(intNode, nullptr);
     EXPECT_EQ(intNode->getValue(), 5);
 }
 
 TEST(TranslatorTests, TestFloatTranslation) {
     FloatNode i(3.23);
-    AstToIttTranslator translator;
+    Arena arena;
+    AstToIttTranslator translator(arena);
     auto result = translator.translate(i);
     ASSERT_NE(result, nullptr);
-    auto* intNode = dynamic_cast<IttFloatNode*>(result.get());
+    auto* intNode = dynamic_cast<IttFloatNode*>(result);
     ASSERT_NE(intNode, nullptr);
     EXPECT_FLOAT_EQ(intNode->getValue(), 3.23);
 }
 
 
 TEST(TranslatorTests, TestBinaryOpTranslation) {
-    auto lhs = std::make_shared<BinaryOperationNode>(
-        std::make_shared<IntegerNode>(2), 
-        std::make_shared<IntegerNode>(3), 
+    Arena arena;
+    auto lhs = arena.make<BinaryOperationNode>(
+        arena.make<IntegerNode>(2), 
+        arena.make<IntegerNode>(3), 
         ADD
     );
-    auto rhs = std::make_shared<IntegerNode>(1);
+    auto rhs = arena.make<IntegerNode>(1);
     BinaryOperationNode bop(lhs, rhs, SUB);  
-    AstToIttTranslator translator;
+    AstToIttTranslator translator(arena);
 
     auto result = translator.translate(bop);
     ASSERT_NE(result, nullptr);
 
-    auto* bopNode = dynamic_cast<IttBinaryOperationNode*>(result.get());
+    auto* bopNode = dynamic_cast<IttBinaryOperationNode*>(result);
     ASSERT_NE(bopNode, nullptr);
 
     auto* ittLhs = dynamic_cast<IttBinaryOperationNode*>(&bopNode->getLhs());
@@ -69,18 +72,19 @@ TEST(TranslatorTests, TestBinaryOpTranslation) {
 }
 
 TEST(TranslatorTests, TestVarDefTranslation) {
-    auto binOp = std::make_shared<BinaryOperationNode>(
-        std::make_shared<IntegerNode>(2), 
-        std::make_shared<IntegerNode>(3), 
+    Arena arena;
+    auto binOp = arena.make<BinaryOperationNode>(
+        arena.make<IntegerNode>(2), 
+        arena.make<IntegerNode>(3), 
         ADD
     );
-    VarDefNode varDef("var1", binOp);
-    AstToIttTranslator translator;
+    VarDefNode varDef(Symbol::intern("var1"), binOp);
+    AstToIttTranslator translator(arena);
     
     auto result = translator.translate(varDef);
     ASSERT_NE(result, nullptr);
 
-    auto* varNode = dynamic_cast<IttVariableNode*>(result.get());
+    auto* varNode = dynamic_cast<IttVariableNode*>(result);
     ASSERT_NE(varNode, nullptr);
 
     auto* content = dynamic_cast<IttBinaryOperationNode*>(&varNode->getContent());
@@ -97,25 +101,26 @@ TEST(TranslatorTests, TestVarDefTranslation) {
 }
 
 TEST(TranslatorTests, TestBlockTranslation) {
-    auto binOp = std::make_shared<BinaryOperationNode>(
-        std::make_shared<IntegerNode>(2), 
-        std::make_shared<IntegerNode>(3), 
+    Arena arena;
+    auto binOp = arena.make<BinaryOperationNode>(
+        arena.make<IntegerNode>(2), 
+        arena.make<IntegerNode>(3), 
         ADD
     );
 
-    std::vector<std::shared_ptr<INode>> nodes;
+    std::vector<INode*> nodes;
     nodes.push_back(binOp);
 
-    BlockNode block(nodes);
-    AstToIttTranslator translator;
+    BlockNode block(arena.copy(nodes));
+    AstToIttTranslator translator(arena);
 
     auto result = translator.translate(block);
     ASSERT_NE(result, nullptr);
 
-    auto* blockNode = dynamic_cast<IttBlockNode*>(result.get());
+    auto* blockNode = dynamic_cast<IttBlockNode*>(result);
     ASSERT_NE(blockNode, nullptr);
 
-    std::vector<std::shared_ptr<IttNode>> sttmts = blockNode->getStatements();
+    Span<IttNode*> sttmts = blockNode->getStatements();
     ASSERT_EQ(sttmts.size(), 1);
 
     auto sttmt = sttmts[0];
@@ -132,3 +137,93 @@ TEST(TranslatorTests, TestBlockTranslation) {
     ASSERT_NE(contentRhs, nullptr);
     EXPECT_EQ(contentRhs->getValue(), 3);
 }
+
+static FunctionNode* sampleFunction(Arena& arena) {
+    auto x = Symbol::intern("x");
+    auto y = Symbol::intern("y");
+
+    auto sum = arena.make<BinaryOperationNode>(
+        arena.make<IdentifierNode>(x),
+        arena.make<BinaryOperationNode>(arena.make<IntegerNode>(2), arena.make<FloatNode>(1.5f), MUL),
+        ADD
+    );
+    auto test = arena.make<BinaryOperationNode>(
+        arena.make<IdentifierNode>(y),
+        arena.make<BooleanNode>(true),
+        NEQ
+    );
+
+    std::vector<INode*> callArgs = {arena.make<IdentifierNode>(y), arena.make<IntegerNode>(3)};
+
+    std::vector<INode*> statements = {
+        arena.make<VarDefNode>(y, sum),
+        arena.make<CallNode>(std::nullopt, Symbol::intern("report"), arena.copy(callArgs)),
+        arena.make<ReturnNode>(test),
+        arena.make<ReturnNode>(nullptr),
+    };
+    std::vector<std::tuple<Symbol, Symbol>> args = {{x, Symbol::intern("Int")}};
+
+    return arena.make<FunctionNode>(Symbol::intern("sample"), Symbol::intern("Bool"), "public",
+                                    arena.copy(args), arena.make<BlockNode>(arena.copy(statements)));
+}
+
+TEST(TranslatorTests, TestFlatMatchesTreeTranslation) {
+    Arena arena;
+    FunctionNode* function = sampleFunction(arena);
+
+    FlatAst flat;
+    FlatIndex root = FlatAstBuilder(flat).build(*function);
+    ASSERT_EQ(flat.kind(root), FlatKind::FUNCTION);
+    ASSERT_EQ(flat.functions().size(), 1u);
+    EXPECT_TRUE(flat.isPublic(root));
+    EXPECT_EQ(flat.paramName(root, 0), "x");
+
+    AstToIttTranslator translator(arena);
+    auto fromTree = translator.translate(*function);
+    auto fromFlat = translator.translate(flat, root);
+
+    ASSERT_NE(fromFlat, nullptr);
+    EXPECT_TRUE(*fromTree == *fromFlat);
+
+    EXPECT_EQ(dynamic_cast<IttFunctionNode&>(*fromFlat).getVisibility(), IttVisibility::PUBLIC);
+    auto& body = dynamic_cast<IttBlockNode&>(dynamic_cast<IttFunctionNode&>(*fromFlat).getBody());
+    ASSERT_EQ(body.getStatements().size(), 4u);
+    auto& call = dynamic_cast<IttCallNode&>(*body.getStatements()[1]);
+    EXPECT_EQ(call.getCallee(), "report");
+    ASSERT_EQ(call.getArguments().size(), 2u);
+    EXPECT_TRUE(*call.getArguments()[1] == IttIntegerNode(3));
+    EXPECT_FALSE(dynamic_cast<IttReturnNode&>(*body.getStatements()[3]).getReturnStmt());
+}
+
+TEST(TranslatorTests, TestFlatEmptyBlockTranslation) {
+    // An empty block as the only node starts past the end of an empty pool.
+    FlatAst flat;
+    FlatIndex block = flat.addBlock({});
+    EXPECT_EQ(flat.statements(block).size(), 0u);
+
+    Arena arena;
+    AstToIttTranslator translator(arena);
+    auto& translated = dynamic_cast<IttBlockNode&>(*translator.translate(flat, block));
+    EXPECT_EQ(translated.getStatements().size(), 0u);
+}
+
+TEST(TranslatorTests, TestSharedTranslation) {
+    Arena arena;
+    FunctionNode* function = sampleFunction(arena);
+    auto x = Symbol::intern("x");
+    std::vector<INode*> statements = {
+        arena.make<VarDefNode>(x, arena.make<BinaryOperationNode>(arena.make<IdentifierNode>(x), arena.make<IntegerNode>(1), ADD)),
+        arena.make<ReturnNode>(arena.make<BinaryOperationNode>(arena.make<IdentifierNode>(x), arena.make<IntegerNode>(1), ADD)),
+    };
+    BlockNode block(arena.copy(statements));
+
+    HashConsingFactory sharing(arena);
+    AstToIttTranslator translator(arena, sharing);
+    AstToIttTranslator plain(arena);
+    EXPECT_TRUE(*translator.translate(*function) == *plain.translate(*function));
+
+    auto& shared = dynamic_cast<IttBlockNode&>(*translator.translate(block));
+    auto& def = dynamic_cast<IttVariableNode&>(*shared.getStatements()[0]);
+    auto& ret = dynamic_cast<IttReturnNode&>(*shared.getStatements()[1]);
+    EXPECT_EQ(&def.getContent(), *ret.getReturnStmt());
+}
@@ -3,74 +3,158 @@
 #include "ast_to_itt_translator.h"
 
 
-std::shared_ptr<IttNode> AstToIttTranslator::translate(INode& node) {
+IttNode* AstToIttTranslator::translate(INode& node) {
     node.accept(*this);
     return _result;
 }
 
+Span<IttNode*> AstToIttTranslator::takePendingNodes(size_t first) {
+    Span<IttNode*> nodes = _arena.copy(_pendingNodes.data() + first, _pendingNodes.size() - first);
+    _pendingNodes.resize(first);
+    return nodes;
+}
+
 void AstToIttTranslator::visit(IntegerNode& node) {
-    this->_result = std::make_shared<IttIntegerNode>(node.getValue());
+    this->_result = makeExpression<IttIntegerNode>(node.getValue());
 }
 
 void AstToIttTranslator::visit(FloatNode& node) {
-    this->_result = std::make_shared<IttFloatNode>(node.getValue());
+    this->_result = makeExpression<IttFloatNode>(node.getValue());
+}
+
+void AstToIttTranslator::visit(BooleanNode& node) {
+    this->_result = makeExpression<IttBooleanNode>(node.getValue());
 }
 
 void AstToIttTranslator::visit(IdentifierNode& node) {
-    this->_result = std::make_shared<IttIdentifierNode>(node.getName());
+    this->_result = makeExpression<IttIdentifierNode>(node.getName());
 }
 
 void AstToIttTranslator::visit(BinaryOperationNode& node) {
     auto lhs = this->translate(node.getLhs());
     auto rhs = this->translate(node.getRhs());
 
-    _result = std::make_shared<IttBinaryOperationNode>(
+    _result = makeExpression<IttBinaryOperationNode>(
         lhs, rhs, mapBinaryOperator(node.getOp()));
 }
 
+void AstToIttTranslator::visit(UnaryOperationNode& node) {
+    auto operand = this->translate(node.getOperand());
+    _result = makeExpression<IttUnaryOperationNode>(operand, mapUnaryOperator(node.getOp()));
+}
+
 void AstToIttTranslator::visit(VarDefNode& node) {
     auto content = this->translate(node.getContent());
-    _result = std::make_shared<IttVariableNode>(node.getName(), content);
+    _result = _arena.make<IttVariableNode>(node.getName(), content);
 }
 
 void AstToIttTranslator::visit(ReturnNode& node) {
     if (auto retDataOpt = node.getRetData()) {
         auto retData = this->translate(**retDataOpt);
-        this->_result = std::make_shared<IttReturnNode>(retData);
+        this->_result = _arena.make<IttReturnNode>(retData);
     } else {
-        this->_result = std::make_shared<IttReturnNode>(nullptr);
+        this->_result = _arena.make<IttReturnNode>(nullptr);
     }
 }
 
 void AstToIttTranslator::visit(BlockNode& node) {
-    std::vector<std::shared_ptr<IttNode>> statements;
+    size_t first = _pendingNodes.size();
 
-    for (const auto& astNode : node.getNodes()) {
-        statements.push_back(this->translate(*astNode));
+    for (INode* astNode : node.getNodes()) {
+        _pendingNodes.push_back(this->translate(*astNode));
     }
 
-    this->_result = std::make_shared<IttBlockNode>(statements);
+    this->_result = _arena.make<IttBlockNode>(takePendingNodes(first));
 }
 
 void AstToIttTranslator::visit(FunctionNode& node) {
-    std::vector<std::pair<std::string, IttType>> parameters;
+    if (_sharing) _sharing->clear();
+    _pendingParams.clear();
 
     for (const auto& arg : node.getArgs()) {
-        std::string argName = std::get<0>(arg);
-        std::string argType = std::get<1>(arg);
-        IttType type = mapType(argType);
+        IttType type = mapType(std::get<1>(arg).str());
 
-        parameters.emplace_back(argName, type);
+        _pendingParams.emplace_back(std::get<0>(arg), type);
     }
+    auto parameters = _arena.copy(_pendingParams);
 
     auto body = this->translate(node.getBody());
-    IttType returnType = mapType(node.getReturnType());
-    _result = std::make_shared<IttFunctionNode>(
-        node.getName(), parameters, body);
+    IttType returnType = mapType(node.getReturnType().str());
+    IttVisibility visibility = node.getVisibility() == "public" ? IttVisibility::PUBLIC : IttVisibility::PRIVATE;
+    _result = _arena.make<IttFunctionNode>(
+        node.getName(), parameters, returnType, body, visibility);
 }
 
 void AstToIttTranslator::visit(CallNode& node) {
+    if (node.getAlias()) {
+        throw std::runtime_error("Calls into other modules are not supported: " +
+                                 std::string(node.getAlias()->str()) + "." + std::string(node.getName().str()));
+    }
+
+    size_t first = _pendingNodes.size();
+    for (INode* arg : node.getArgs()) {
+        _pendingNodes.push_back(this->translate(*arg));
+    }
+
+    this->_result = _arena.make<IttCallNode>(node.getName(), takePendingNodes(first));
+}
 
+IttNode* AstToIttTranslator::translate(const FlatAst& ast, FlatIndex node) {
+    switch (ast.kind(node)) {
+        case FlatKind::INTEGER:
+            return makeExpression<IttIntegerNode>(ast.intValue(node));
+        case FlatKind::FLOAT:
+            return makeExpression<IttFloatNode>(ast.floatValue(node));
+        case FlatKind::BOOLEAN:
+            return makeExpression<IttBooleanNode>(ast.boolValue(node));
+        case FlatKind::IDENTIFIER:
+            return makeExpression<IttIdentifierNode>(ast.name(node));
+        case FlatKind::BINARY_OPERATION: {
+            auto lhs = translate(ast, ast.lhs(node));
+            auto rhs = translate(ast, ast.rhs(node));
+            return makeExpression<IttBinaryOperationNode>(lhs, rhs, mapBinaryOperator(ast.op(node)));
+        }
+        case FlatKind::UNARY_OPERATION:
+            return makeExpression<IttUnaryOperationNode>(translate(ast, ast.operand(node)),
+                                                         mapUnaryOperator(ast.unaryOp(node)));
+        case FlatKind::VAR_DEF:
+            return _arena.make<IttVariableNode>(ast.name(node), translate(ast, ast.content(node)));
+        case FlatKind::RETURN:
+            if (ast.returnValue(node) == noFlatNode) {
+                return _arena.make<IttReturnNode>(nullptr);
+            }
+            return _arena.make<IttReturnNode>(translate(ast, ast.returnValue(node)));
+        case FlatKind::BLOCK: {
+            size_t first = _pendingNodes.size();
+            for (FlatIndex statement : ast.statements(node)) {
+                _pendingNodes.push_back(translate(ast, statement));
+            }
+            return _arena.make<IttBlockNode>(takePendingNodes(first));
+        }
+        case FlatKind::FUNCTION: {
+            if (_sharing) _sharing->clear();
+            _pendingParams.clear();
+            for (uint32_t param = 0; param < ast.paramCount(node); ++param) {
+                _pendingParams.emplace_back(ast.paramName(node, param), mapType(ast.paramType(node, param).str()));
+            }
+            auto parameters = _arena.copy(_pendingParams);
+            return _arena.make<IttFunctionNode>(ast.name(node), parameters, mapType(ast.returnType(node).str()),
+                                                translate(ast, ast.body(node)),
+                                                ast.isPublic(node) ? IttVisibility::PUBLIC : IttVisibility::PRIVATE);
+        }
+        case FlatKind::CALL: {
+            if (!ast.callAlias(node).empty()) {
+                throw std::runtime_error("Calls into other modules are not supported: " +
+                                         std::string(ast.callAlias(node).str()) + "." + std::string(ast.name(node).str()));
+            }
+            size_t first = _pendingNodes.size();
+            for (FlatIndex arg : ast.callArgs(node)) {
+                _pendingNodes.push_back(translate(ast, arg));
+            }
+            return _arena.make<IttCallNode>(ast.name(node), takePendingNodes(first));
+        }
+    }
+    throw std::runtime_error("Unknown FlatKind");
 }
 
 IttBinaryOperation AstToIttTranslator::mapBinaryOperator(BinaryOperator op) {
@@ -79,20 +163,35 @@ IttBinaryOperation AstToIttTranslator::mapBinaryOperator(BinaryOperator op) {
             case BinaryOperator::SUB: return IttBinaryOperation::SUB;
             case BinaryOperator::DIV: return IttBinaryOperation::DIV;
             case BinaryOperator::MUL: return IttBinaryOperation::MUL;
+            case BinaryOperator::AND: return IttBinaryOperation::AND;
+            case BinaryOperator::OR: return IttBinaryOperation::OR;
+            case BinaryOperator::LT: return IttBinaryOperation::LESS_THEN;
+            case BinaryOperator::GT: return IttBinaryOperation::GREATER_THEN;
+            case BinaryOperator::LTE: return IttBinaryOperation::LESS_EQUALS;
+            case BinaryOperator::GTE: return IttBinaryOperation::GREATER_EQUALS;
+            case BinaryOperator::EQ: return IttBinaryOperation::EQUALS;
+            case BinaryOperator::NEQ: return IttBinaryOperation::NOT_EQUALS;
     }
     throw std::runtime_error("Unknown BinaryOperator");
 }
 
-IttType AstToIttTranslator::mapType(const std::string& typeStr) {
-    if (typeStr == "int") {
+IttUnaryOperation AstToIttTranslator::mapUnaryOperator(UnaryOperator op) {
+    switch (op) {
+            case UnaryOperator::NEG: return IttUnaryOperation::NEG;
+    }
+    throw std::runtime_error("Unknown UnaryOperator");
+}
+
+IttType AstToIttTranslator::mapType(std::string_view typeStr) {
+    if (typeStr == "Int") {
         return IttType(IttType::INT);
-    } else if (typeStr == "float") {
+    } else if (typeStr == "Float") {
         return IttType(IttType::FLOAT);
-    } else if (typeStr == "void") {
+    } else if (typeStr == "Void") {
         return IttType(IttType::VOID);
-    } else if (typeStr == "bool") {
+    } else if (typeStr == "Bool") {
         return IttType(IttType::BOOL);
-    } else if (typeStr == "char") {
+    } else if (typeStr == "Char") {
         return IttType(IttType::CHAR);
     } else {
         return IttType(IttType::UNRESOLVED);
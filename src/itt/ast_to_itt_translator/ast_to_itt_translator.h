@@ -1,19 +1,50 @@
 #pragma once
 #include "../../ast/ast.h"
+#include "../../ast/flat_ast.h"
+#include "../hash_consing_factory.h"
 #include "../itt.h"
-#include <memory.h>
 #include <optional>
+#include <vector>
 
+// Builds the ITT into the given arena, which must outlive the result.
 class AstToIttTranslator : public IVisitor {
   private:
-    std::shared_ptr<IttNode> _result;
+    Arena& _arena;
+    HashConsingFactory* _sharing;
+    IttNode* _result;
+
+    // Scratch stacks for children whose count is only known once they are
+    // all translated; copied into the arena when their parent is built.
+    std::vector<IttNode*> _pendingNodes;
+    std::vector<std::pair<Symbol, IttType>> _pendingParams;
+
+    Span<IttNode*> takePendingNodes(size_t first);
+
+    template <typename T, typename... Args>
+    IttNode* makeExpression(Args&&... args) {
+        if (_sharing) return _sharing->make<T>(std::forward<Args>(args)...);
+        return _arena.make<T>(std::forward<Args>(args)...);
+    }
   public:
-    std::shared_ptr<IttNode> translate(INode& node);
+    explicit AstToIttTranslator(Arena& arena) : _arena(arena), _sharing(nullptr), _result(nullptr) {}
+
+    // Builds expressions through sharing, so that equal ones within a
+    // function are one node. The factory is cleared at every function.
+    AstToIttTranslator(Arena& arena, HashConsingFactory& sharing)
+        : _arena(arena), _sharing(&sharing), _result(nullptr) {}
+
+    IttNode* translate(INode& node);
+
+    // Same result as translating the equivalent tree, walked with a switch
+    // over the node kind instead of visitor dispatch.
+    IttNode* translate(const FlatAst& ast, FlatIndex node);
 
     void visit(IntegerNode& node) override;
     void visit(FloatNode& node) override;
+    void visit(BooleanNode& node) override;
     void visit(IdentifierNode& node) override;
     void visit(BinaryOperationNode& node) override;
+    void visit(UnaryOperationNode& node) override;
     void visit(VarDefNode& node) override;
     void visit(ReturnNode& node) override;
     void visit(BlockNode& node) override;
@@ -22,5 +53,6 @@ class AstToIttTranslator : public IVisitor {
   
   private:
     IttBinaryOperation mapBinaryOperator(BinaryOperator op);
-    IttType mapType(const std::string& typeStr);
+    IttUnaryOperation mapUnaryOperator(UnaryOperator op);
+    IttType mapType(std::string_view typeStr);
 };
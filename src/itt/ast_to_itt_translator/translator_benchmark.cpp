@@ -0,0 +1,213 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "ast_to_itt_translator.h"
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// A function with a few statements over nested arithmetic, roughly what the
+// parser produces for one generated component.
+static FunctionNode* generateFunction(Arena& arena, int index) {
+    Symbol input = Symbol::intern("input_value");
+    Symbol scaled = Symbol::intern("scaled_value");
+    Symbol offset = Symbol::intern("component_offset_" + std::to_string(index));
+
+    auto product = arena.make<BinaryOperationNode>(arena.make<IdentifierNode>(input), arena.make<IntegerNode>(index), MUL);
+    auto shifted = arena.make<BinaryOperationNode>(product, arena.make<FloatNode>(3.25f), ADD);
+    auto scaledValue = arena.make<BinaryOperationNode>(shifted, arena.make<IdentifierNode>(offset), SUB);
+
+    auto inRange = arena.make<BinaryOperationNode>(
+        arena.make<BinaryOperationNode>(arena.make<IdentifierNode>(scaled), arena.make<IntegerNode>(10), GTE),
+        arena.make<BinaryOperationNode>(arena.make<IdentifierNode>(scaled), arena.make<IntegerNode>(index), NEQ),
+        AND);
+
+    std::vector<INode*> statements = {
+        arena.make<VarDefNode>(scaled, scaledValue),
+        arena.make<VarDefNode>(Symbol::intern("in_range"), inRange),
+        arena.make<ReturnNode>(arena.make<BinaryOperationNode>(arena.make<IdentifierNode>(scaled), arena.make<IntegerNode>(2), DIV)),
+    };
+    std::vector<std::tuple<Symbol, Symbol>> args = {{input, Symbol::intern("Int")}};
+
+    return arena.make<FunctionNode>(Symbol::intern("generated_component_compute_" + std::to_string(index)),
+                                    Symbol::intern("Int"), "public", arena.copy(args),
+                                    arena.make<BlockNode>(arena.copy(statements)));
+}
+
+// Traversal cost on its own: sums every integer literal in the tree.
+class LiteralSum : public IVisitor {
+public:
+    long sum = 0;
+
+    void visit(IntegerNode& node) override { sum += node.getValue(); }
+    void visit(FloatNode&) override {}
+    void visit(BooleanNode&) override {}
+    void visit(IdentifierNode&) override {}
+    void visit(BinaryOperationNode& node) override {
+        node.getLhs().accept(*this);
+        node.getRhs().accept(*this);
+    }
+    void visit(UnaryOperationNode& node) override { node.getOperand().accept(*this); }
+    void visit(VarDefNode& node) override { node.getContent().accept(*this); }
+    void visit(ReturnNode& node) override {
+        if (auto value = node.getRetData()) (*value)->accept(*this);
+    }
+    void visit(BlockNode& node) override {
+        for (INode* statement : node.getNodes()) statement->accept(*this);
+    }
+    void visit(FunctionNode& node) override { node.getBody().accept(*this); }
+    void visit(CallNode& node) override {
+        for (INode* arg : node.getArgs()) arg->accept(*this);
+    }
+};
+
+static long literalSum(const FlatAst& ast, FlatIndex node) {
+    switch (ast.kind(node)) {
+        case FlatKind::INTEGER: return ast.intValue(node);
+        case FlatKind::BINARY_OPERATION: return literalSum(ast, ast.lhs(node)) + literalSum(ast, ast.rhs(node));
+        case FlatKind::UNARY_OPERATION: return literalSum(ast, ast.operand(node));
+        case FlatKind::VAR_DEF: return literalSum(ast, ast.content(node));
+        case FlatKind::RETURN: return ast.returnValue(node) == noFlatNode ? 0 : literalSum(ast, ast.returnValue(node));
+        case FlatKind::FUNCTION: return literalSum(ast, ast.body(node));
+        case FlatKind::BLOCK: {
+            long sum = 0;
+            for (FlatIndex statement : ast.statements(node)) sum += literalSum(ast, statement);
+            return sum;
+        }
+        case FlatKind::CALL: {
+            long sum = 0;
+            for (FlatIndex arg : ast.callArgs(node)) sum += literalSum(ast, arg);
+            return sum;
+        }
+        default: return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    int functions = argc > 1 ? std::stoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+#ifdef __GLIBC__
+    // Keep freed arena blocks mapped, so that which run happens to get fresh
+    // pages from the kernel does not decide the timings.
+    mallopt(M_MMAP_THRESHOLD, 1 << 30);
+    mallopt(M_TRIM_THRESHOLD, 1 << 30);
+#endif
+
+    Arena arena;
+    std::vector<FunctionNode*> program;
+    for (int i = 0; i < functions; ++i) {
+        program.push_back(generateFunction(arena, i));
+    }
+
+    FlatAst flat;
+    FlatAstBuilder builder(flat);
+    for (FunctionNode* function : program) {
+        builder.build(*function);
+    }
+
+    double bestTreeSeconds = 1e100;
+    double bestFlatSeconds = 1e100;
+    double bestTreeWalkSeconds = 1e100;
+    double bestFlatWalkSeconds = 1e100;
+    double bestFreeSeconds = 1e100;
+    double bestSharedSeconds = 1e100;
+    size_t plainBytes = 0;
+    size_t sharedBytes = 0;
+    size_t sharedHits = 0;
+    long checksum = 0;
+    size_t allocations = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        std::vector<IttNode*> results;
+        results.reserve(program.size());
+
+        auto ittArena = std::make_unique<Arena>();
+        size_t before = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        AstToIttTranslator translator(*ittArena);
+        for (FunctionNode* function : program) {
+            results.push_back(translator.translate(*function));
+        }
+        auto end = std::chrono::steady_clock::now();
+        allocations = allocationCount.load() - before;
+        bestTreeSeconds = std::min(bestTreeSeconds, std::chrono::duration<double>(end - start).count());
+
+        start = std::chrono::steady_clock::now();
+        results.clear();
+        ittArena.reset();
+        end = std::chrono::steady_clock::now();
+        bestFreeSeconds = std::min(bestFreeSeconds, std::chrono::duration<double>(end - start).count());
+
+        Arena flatIttArena;
+        AstToIttTranslator flatTranslator(flatIttArena);
+        start = std::chrono::steady_clock::now();
+        for (FlatIndex function : flat.functions()) {
+            results.push_back(flatTranslator.translate(flat, function));
+        }
+        end = std::chrono::steady_clock::now();
+        bestFlatSeconds = std::min(bestFlatSeconds, std::chrono::duration<double>(end - start).count());
+
+        Arena sharedIttArena;
+        HashConsingFactory sharing(sharedIttArena);
+        AstToIttTranslator sharingTranslator(sharedIttArena, sharing);
+        start = std::chrono::steady_clock::now();
+        for (FunctionNode* function : program) {
+            sharingTranslator.translate(*function);
+        }
+        end = std::chrono::steady_clock::now();
+        bestSharedSeconds = std::min(bestSharedSeconds, std::chrono::duration<double>(end - start).count());
+        plainBytes = flatIttArena.bytesUsed();
+        sharedBytes = sharedIttArena.bytesUsed();
+        sharedHits = sharing.hits();
+
+        start = std::chrono::steady_clock::now();
+        LiteralSum visitor;
+        for (FunctionNode* function : program) {
+            function->accept(visitor);
+        }
+        end = std::chrono::steady_clock::now();
+        bestTreeWalkSeconds = std::min(bestTreeWalkSeconds, std::chrono::duration<double>(end - start).count());
+
+        start = std::chrono::steady_clock::now();
+        long sum = 0;
+        for (FlatIndex function : flat.functions()) {
+            sum += literalSum(flat, function);
+        }
+        end = std::chrono::steady_clock::now();
+        bestFlatWalkSeconds = std::min(bestFlatWalkSeconds, std::chrono::duration<double>(end - start).count());
+        checksum = visitor.sum - sum;
+    }
+
+    std::cout << "functions:      " << functions << ", " << flat.size() << " nodes\n";
+    std::cout << "walk tree:      " << bestTreeWalkSeconds * 1000 << " ms, flat " << bestFlatWalkSeconds * 1000
+              << " ms" << (checksum ? " (MISMATCH)" : "") << "\n";
+    std::cout << "tree visitor:   " << bestTreeSeconds * 1000 << " ms (" << bestTreeSeconds / flat.size() * 1e9 << " ns/node)\n";
+    std::cout << "ITT allocs:     " << allocations << " (" << static_cast<double>(allocations) / flat.size() << " per node)\n";
+    std::cout << "free ITT:       " << bestFreeSeconds * 1000 << " ms\n";
+    std::cout << "flat switch:    " << bestFlatSeconds * 1000 << " ms (" << bestFlatSeconds / flat.size() * 1e9 << " ns/node)\n";
+    std::cout << "hash-consed:    " << bestSharedSeconds * 1000 << " ms, " << sharedHits << " nodes reused, ITT "
+              << plainBytes / 1024 << " KiB -> " << sharedBytes / 1024 << " KiB\n";
+    std::cout << "arena AST:      " << arena.bytesUsed() / flat.size() << " bytes/node, flat AST "
+              << (flat.size() * 13 + flat.functions().size() * 4) / flat.size() << "+ bytes/node\n";
+
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "../itt.h"
+#include "../peephole/peephole.h"
+
+// Evaluates operations on literals and applies algebraic identities, so
+// codegen gets no work that is known at compile time. The rewrites are the
+// rules in peephole_rules.h; this names the pass and sums their hits.
+//
+// Int is a wrapping 32-bit integer: +, - and * fold modulo 2^32. A division
+// by zero, or INT_MIN / -1, is left for run time. Multiplication by a power
+// of two becomes a shift; division is not reduced, since a signed shift
+// rounds toward negative infinity where division rounds toward zero. Float
+// folds use IEEE single precision, and identities that would change the
+// sign of a zero or the result for NaN or infinity (x + 0.0, x * 0.0) are
+// not applied. x * 0 and x && false drop x, unless x holds a call.
+class ConstantFolder {
+    PeepholeRewriter _rewriter;
+
+public:
+    explicit ConstantFolder(Arena& arena) : _rewriter(arena) {}
+
+    // The folded function; function itself if nothing changed.
+    IttFunctionNode* run(IttFunctionNode& function) { return _rewriter.run(function); }
+
+    // Operations evaluated, identities (reassociation included) applied, and
+    // multiplications turned into shifts, over all runs.
+    size_t folded() const { return _rewriter.hits(PeepholeCategory::FOLD); }
+    size_t simplified() const {
+        return _rewriter.hits(PeepholeCategory::IDENTITY) + _rewriter.hits(PeepholeCategory::REASSOCIATION);
+    }
+    size_t strengthReduced() const { return _rewriter.hits(PeepholeCategory::STRENGTH_REDUCTION); }
+
+    // The three counts by name, for the pass manager.
+    std::vector<std::pair<const char*, size_t>> counters() const {
+        return {{"folded", folded()}, {"simplified", simplified()}, {"strength reduced", strengthReduced()}};
+    }
+};
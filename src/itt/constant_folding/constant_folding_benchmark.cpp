@@ -0,0 +1,92 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "constant_folding.h"
+
+// Balanced arithmetic over a parameter and small literals, like generated
+// code that spells out its scaling factors: most subtrees are constant and
+// many multiply by powers of two.
+static IttNode* generateExpression(Arena& arena, int depth, int seed, Symbol parameter) {
+    if (depth == 0) {
+        if (seed % 7 == 0) return arena.make<IttIdentifierNode>(parameter);
+        return arena.make<IttIntegerNode>(seed % 5);
+    }
+    static const IttBinaryOperation ops[] = {IttBinaryOperation::ADD, IttBinaryOperation::MUL, IttBinaryOperation::SUB};
+    return arena.make<IttBinaryOperationNode>(generateExpression(arena, depth - 1, seed * 3 + 1, parameter),
+                                              generateExpression(arena, depth - 1, seed * 3 + 2, parameter), ops[seed % 3]);
+}
+
+static IttFunctionNode* generateFunction(Arena& arena, int statements, int depth) {
+    Symbol parameter = Symbol::intern("input");
+    std::vector<IttNode*> body;
+    for (int i = 0; i < statements; ++i) {
+        auto value = generateExpression(arena, depth, i, parameter);
+        if (i % 2 == 0) {
+            body.push_back(arena.make<IttVariableNode>(Symbol::intern("local_" + std::to_string(i % 16)), value));
+        } else {
+            body.push_back(arena.make<IttReturnNode>(value));
+        }
+    }
+    std::vector<std::pair<Symbol, IttType>> params = {{parameter, IttType(IttType::INT)}};
+    return arena.make<IttFunctionNode>(Symbol::intern("generated"), arena.copy(params), IttType(IttType::INT),
+                                       arena.make<IttBlockNode>(arena.copy(body)));
+}
+
+static size_t countNodes(const IttNode& node) {
+    return 1 + visitItt(node, [](const auto& concrete) -> size_t {
+        using Node = std::decay_t<decltype(concrete)>;
+        if constexpr (std::is_same_v<Node, IttBinaryOperationNode>) {
+            return countNodes(concrete.getLhs()) + countNodes(concrete.getRhs());
+        } else if constexpr (std::is_same_v<Node, IttVariableNode>) {
+            return countNodes(concrete.getContent());
+        } else if constexpr (std::is_same_v<Node, IttFunctionNode>) {
+            return countNodes(concrete.getBody());
+        } else if constexpr (std::is_same_v<Node, IttBlockNode>) {
+            size_t count = 0;
+            for (const IttNode* statement : concrete.getStatements()) count += countNodes(*statement);
+            return count;
+        } else if constexpr (std::is_same_v<Node, IttReturnNode>) {
+            return concrete.getReturnStmt() ? countNodes(**concrete.getReturnStmt()) : 0;
+        } else {
+            return 0;
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    int statements = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int depth = argc > 2 ? std::stoi(argv[2]) : 8;
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    Arena arena;
+    IttFunctionNode* function = generateFunction(arena, statements, depth);
+    size_t before = countNodes(*function);
+
+    double best = 1e100;
+    IttFunctionNode* result = function;
+    size_t folded = 0, simplified = 0, reduced = 0;
+    for (int i = 0; i < iterations; ++i) {
+        Arena output;
+        ConstantFolder folder(output);
+        auto start = std::chrono::steady_clock::now();
+        result = folder.run(*function);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+
+        if (i + 1 == iterations) {
+            size_t after = countNodes(*result);
+            folded = folder.folded();
+            simplified = folder.simplified();
+            reduced = folder.strengthReduced();
+            std::cout << "nodes:          " << before << " -> " << after << "\n";
+        }
+    }
+
+    std::cout << "fold:           " << best * 1000 << " ms (" << best / before * 1e9 << " ns/node)\n";
+    std::cout << "rewrites:       " << folded << " folded, " << simplified << " identities, " << reduced
+              << " shifts\n";
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <climits>
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "../itt_test_helpers.h"
+#include "constant_folding.h"
+
+// The value of the function's single return statement, folded.
+static IttNode& returned(const std::string& source) {
+    static Arena arena;
+    ConstantFolder folder(arena);
+    return returnedValue(*folder.run(inferred(source, arena)));
+}
+
+static IttNode* shiftBy(IttNode& node) {
+    auto* shift = ittCast<IttBinaryOperationNode>(node);
+    if (!shift || shift->getOperation() != IttBinaryOperation::SHL) return nullptr;
+    return &shift->getRhs();
+}
+
+TEST(ConstantFoldingTest, FoldsLiteralsTest) {
+    EXPECT_TRUE(returned("fn f() -> Int { ret 2 + 3 - 1; }") == IttIntegerNode(4));
+    EXPECT_TRUE(returned("fn f() -> Int { ret 7 / 2 * 3; }") == IttIntegerNode(9));
+    EXPECT_TRUE(returned("fn f() -> Float { ret 1.5 * 2.0; }") == IttFloatNode(3.0f));
+    EXPECT_TRUE(returned("fn f() -> Bool { ret 1 + 1 < 3 && 2.0 >= 2.0; }") == IttBooleanNode(true));
+    EXPECT_TRUE(returned("fn f() -> Bool { ret !(true || false); }") == IttBooleanNode(false));
+    EXPECT_EQ(returned("fn f() -> Int { ret 2 + 3 - 1; }").getType().getKind(), IttType::INT);
+}
+
+TEST(ConstantFoldingTest, WrapsLikeInt32Test) {
+    EXPECT_TRUE(returned("fn f() -> Int { ret 2147483647 + 1; }") == IttIntegerNode(INT_MIN));
+    EXPECT_TRUE(returned("fn f() -> Int { ret 65536 * 65536; }") == IttIntegerNode(0));
+    EXPECT_TRUE(returned("fn f() -> Int { ret 0 - 2147483647 - 2; }") == IttIntegerNode(INT_MAX));
+
+    // Undefined at run time, so left for run time.
+    EXPECT_EQ(returned("fn f() -> Int { ret 1 / 0; }").getKind(), IttKind::BINARY_OPERATION);
+    EXPECT_EQ(returned("fn f() -> Int { ret (0 - 2147483647 - 1) / (0 - 1); }").getKind(), IttKind::BINARY_OPERATION);
+}
+
+TEST(ConstantFoldingTest, IdentitiesTest) {
+    auto x = Symbol::intern("x");
+    IttIdentifierNode identifier(x);
+
+    EXPECT_TRUE(returned("fn f(x Int) -> Int { ret x * 1 + 0; }") == identifier);
+    EXPECT_TRUE(returned("fn f(x Int) -> Int { ret 0 + (1 * x) / 1 - 0; }") == identifier);
+    EXPECT_TRUE(returned("fn f(x Int) -> Int { ret x * 0; }") == IttIntegerNode(0));
+    EXPECT_TRUE(returned("fn f(x Int) -> Int { ret (x + 1) - (x + 1); }") == IttIntegerNode(0));
+    EXPECT_TRUE(returned("fn f(x Bool) -> Bool { ret x && true || false; }") == identifier);
+    EXPECT_TRUE(returned("fn f(x Bool) -> Bool { ret x && false; }") == IttBooleanNode(false));
+    EXPECT_TRUE(returned("fn f(x Float) -> Float { ret x * 1.0 - 0.0; }") == identifier);
+    EXPECT_TRUE(returned("fn f(x Float) -> Float { ret -(x * 1.0); }") ==
+                IttUnaryOperationNode(&identifier, IttUnaryOperation::NEG));
+
+    // Not identities for IEEE floats: -0.0 + 0.0 is +0.0, and NaN * 0.0 is NaN.
+    EXPECT_EQ(returned("fn f(x Float) -> Float { ret x + 0.0; }").getKind(), IttKind::BINARY_OPERATION);
+    EXPECT_EQ(returned("fn f(x Float) -> Float { ret x * 0.0; }").getKind(), IttKind::BINARY_OPERATION);
+}
+
+TEST(ConstantFoldingTest, StrengthReductionTest) {
+    IttNode* shift = shiftBy(returned("fn f(x Int) -> Int { ret x * 8; }"));
+    ASSERT_NE(shift, nullptr);
+    EXPECT_TRUE(*shift == IttIntegerNode(3));
+
+    shift = shiftBy(returned("fn f(x Int) -> Int { ret 1024 * (x + 1); }"));
+    ASSERT_NE(shift, nullptr);
+    EXPECT_TRUE(*shift == IttIntegerNode(10));
+
+    EXPECT_EQ(shiftBy(returned("fn f(x Int) -> Int { ret x * 6; }")), nullptr);
+    EXPECT_EQ(shiftBy(returned("fn f(x Int) -> Int { ret x / 8; }")), nullptr);
+    EXPECT_EQ(shiftBy(returned("fn f(x Float) -> Float { ret x * 2.0; }")), nullptr);
+}
+
+TEST(ConstantFoldingTest, SharesUntouchedSubtreesTest) {
+    Arena arena;
+    ConstantFolder folder(arena);
+    auto& unchanged = *folder.run(inferred("fn f(x Int) -> Int { y = x + 3; ret y; }", arena));
+    EXPECT_EQ(folder.folded() + folder.simplified() + folder.strengthReduced(), 0u);
+
+    ConstantFolder again(arena);
+    EXPECT_EQ(again.run(unchanged), &unchanged);
+
+    auto& function = *folder.run(inferred("fn f(x Int) -> Int { y = x + 3; ret 2 * 2; }", arena));
+    EXPECT_EQ(function.getType().getKind(), IttType::INT);
+    EXPECT_EQ(folder.folded(), 1u);
+    auto& body = static_cast<IttBlockNode&>(function.getBody());
+    EXPECT_EQ(body.getStatements()[0]->getType().getKind(), IttType::INT);
+}
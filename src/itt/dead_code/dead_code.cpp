@@ -0,0 +1,157 @@
+#include <algorithm>
+
+#include "dead_code.h"
+
+template <typename F>
+void DeadCodeEliminator::forEachReference(IttNode& root, F&& f) {
+    size_t first = _pending.size();
+    _pending.push_back(&root);
+
+    while (_pending.size() > first) {
+        IttNode* node = _pending.back();
+        _pending.pop_back();
+
+        switch (node->getKind()) {
+            case IttKind::IDENTIFIER:
+                f(*node);
+                break;
+            case IttKind::CALL:
+                f(*node);
+                for (IttNode* argument : static_cast<IttCallNode*>(node)->getArguments()) {
+                    _pending.push_back(argument);
+                }
+                break;
+            case IttKind::BINARY_OPERATION: {
+                auto* binary = static_cast<IttBinaryOperationNode*>(node);
+                _pending.push_back(&binary->getLhs());
+                _pending.push_back(&binary->getRhs());
+                break;
+            }
+            case IttKind::UNARY_OPERATION:
+                _pending.push_back(&static_cast<IttUnaryOperationNode*>(node)->getOperand());
+                break;
+            case IttKind::VARIABLE:
+                _pending.push_back(&static_cast<IttVariableNode*>(node)->getContent());
+                break;
+            case IttKind::RETURN:
+                if (auto value = static_cast<IttReturnNode*>(node)->getReturnStmt()) _pending.push_back(*value);
+                break;
+            case IttKind::BLOCK:
+                for (IttNode* statement : static_cast<IttBlockNode*>(node)->getStatements()) {
+                    _pending.push_back(statement);
+                }
+                break;
+            case IttKind::FUNCTION:
+                _pending.push_back(&static_cast<IttFunctionNode*>(node)->getBody());
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool DeadCodeEliminator::alwaysReturns(const IttNode& statement) {
+    if (statement.getKind() == IttKind::RETURN) return true;
+    if (auto* block = ittCast<IttBlockNode>(statement)) {
+        auto statements = block->getStatements();
+        return std::any_of(statements.begin(), statements.end(),
+                           [](const IttNode* inner) { return alwaysReturns(*inner); });
+    }
+    return false;
+}
+
+// The block without dead statements. On entry _live holds the names read
+// after the block, on exit the names read before it.
+IttNode* DeadCodeEliminator::eliminateBlock(IttBlockNode& block) {
+    auto statements = block.getStatements();
+    size_t reachable = 0;
+    while (reachable < statements.size() && !alwaysReturns(*statements[reachable])) reachable++;
+    if (reachable < statements.size()) reachable++;
+    _unreachableStatements += statements.size() - reachable;
+    bool changed = reachable != statements.size();
+
+    auto markRead = [this](IttNode& node) {
+        if (auto* identifier = ittCast<IttIdentifierNode>(node)) _live.insert(identifier->getName());
+    };
+
+    // Kept statements, last first.
+    size_t first = _statements.size();
+    for (size_t i = reachable; i-- > 0;) {
+        IttNode* statement = statements[i];
+        switch (statement->getKind()) {
+            case IttKind::RETURN:
+                // Only the returned value is read after a return.
+                _live.clear();
+                forEachReference(*statement, markRead);
+                break;
+            case IttKind::VARIABLE: {
+                auto& variable = static_cast<IttVariableNode&>(*statement);
+                if (_live.erase(variable.getName()) == 0) {
+                    _unusedVariables++;
+                    changed = true;
+                    bool calls = false;
+                    forEachReference(variable.getContent(), [&](IttNode& node) {
+                        calls |= node.getKind() == IttKind::CALL;
+                    });
+                    if (!calls) continue;
+                    // The value is still computed for its calls.
+                    statement = &variable.getContent();
+                }
+                forEachReference(variable.getContent(), markRead);
+                break;
+            }
+            case IttKind::BLOCK: {
+                IttNode* inner = eliminateBlock(static_cast<IttBlockNode&>(*statement));
+                changed |= inner != statement;
+                statement = inner;
+                break;
+            }
+            default:
+                forEachReference(*statement, markRead);
+        }
+        _statements.push_back(statement);
+    }
+
+    IttNode* result = &block;
+    if (changed) {
+        std::reverse(_statements.begin() + first, _statements.end());
+        result = make<IttBlockNode>(block, _arena.copy(_statements.data() + first, _statements.size() - first));
+    }
+    _statements.resize(first);
+    return result;
+}
+
+IttFunctionNode* DeadCodeEliminator::run(IttFunctionNode& function) {
+    auto* block = ittCast<IttBlockNode>(function.getBody());
+    if (!block) return &function;
+
+    _live.clear();
+    IttNode* body = eliminateBlock(*block);
+    if (body == block) return &function;
+
+    return static_cast<IttFunctionNode*>(make<IttFunctionNode>(
+        function, function.getName(), function.getParameters(), function.getReturnType(), body,
+        function.getVisibility()));
+}
+
+void DeadCodeEliminator::prune(std::vector<IttFunctionNode*>& functions) {
+    std::vector<Symbol> callees;
+    std::vector<bool> reached = reachableFunctions(functions, [&](size_t caller) -> const std::vector<Symbol>& {
+        callees.clear();
+        forEachReference(*functions[caller], [&](IttNode& node) {
+            if (auto* call = ittCast<IttCallNode>(node)) callees.push_back(call->getCallee());
+        });
+        return callees;
+    });
+    _prunedFunctions += prune(functions, reached);
+}
+
+size_t DeadCodeEliminator::prune(std::vector<IttFunctionNode*>& functions, const std::vector<bool>& reached) {
+    size_t kept = 0;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (reached[i]) functions[kept++] = functions[i];
+    }
+    size_t pruned = functions.size() - kept;
+    functions.resize(kept);
+    return pruned;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../itt.h"
+
+// Removes code that cannot affect a program's result.
+//
+// run() handles one function. A block keeps its statements up to the first
+// one that always returns, which is a return or a nested block that holds
+// one. A variable definition is dropped when nothing reads the name before
+// the next definition or the end of the function. Blocks are straight-line
+// code, so one backward sweep with a set of live names decides this.
+// A call may have side effects, so an unread definition whose value holds
+// one becomes an expression statement with that value; any other is dropped
+// whole. Expression statements are kept.
+//
+// prune() handles a whole program. Public and extern functions, and main,
+// are its roots. Private functions that no call from a root reaches are
+// removed.
+//
+// Nodes are never changed in place, as in the other passes: changed blocks
+// and their ancestors are rebuilt in the arena with their types, and
+// untouched statements are shared with the input.
+class DeadCodeEliminator {
+    Arena& _arena;
+
+    std::unordered_set<Symbol> _live;
+    std::vector<IttNode*> _pending;
+    std::vector<IttNode*> _statements;
+
+    size_t _unreachableStatements;
+    size_t _unusedVariables;
+    size_t _prunedFunctions;
+
+    template <typename T, typename... Args>
+    IttNode* make(const IttNode& replacing, Args&&... args) {
+        T* node = _arena.make<T>(std::forward<Args>(args)...);
+        node->setType(replacing.getType());
+        return node;
+    }
+
+    // Calls f with every identifier or call in expression.
+    template <typename F>
+    void forEachReference(IttNode& expression, F&& f);
+
+    static bool alwaysReturns(const IttNode& statement);
+    IttNode* eliminateBlock(IttBlockNode& block);
+
+public:
+    explicit DeadCodeEliminator(Arena& arena)
+        : _arena(arena), _unreachableStatements(0), _unusedVariables(0), _prunedFunctions(0) {}
+
+    // The function without dead statements; function itself if it has none.
+    IttFunctionNode* run(IttFunctionNode& function);
+
+    // Drops the private functions the roots never call, keeping the order
+    // of the rest.
+    void prune(std::vector<IttFunctionNode*>& functions);
+    // Same, with reached computed beforehand by reachableFunctions; returns
+    // how many functions were dropped.
+    static size_t prune(std::vector<IttFunctionNode*>& functions, const std::vector<bool>& reached);
+
+    // Statements after a return, variable definitions never read, and
+    // functions never called, removed over all runs.
+    size_t unreachableStatements() const { return _unreachableStatements; }
+    size_t unusedVariables() const { return _unusedVariables; }
+    size_t prunedFunctions() const { return _prunedFunctions; }
+
+    // The counts of run() by name, for the pass manager.
+    std::vector<std::pair<const char*, size_t>> counters() const {
+        return {{"unreachable statements", _unreachableStatements}, {"unused variables", _unusedVariables}};
+    }
+};
+
+// Which of functions a chain of calls from a root (see DeadCodeEliminator)
+// reaches; callees(i) is an iterable of the names function i calls.
+template <typename Callees>
+std::vector<bool> reachableFunctions(const std::vector<IttFunctionNode*>& functions, Callees&& callees) {
+    std::unordered_map<Symbol, size_t> indexes;
+    for (size_t i = 0; i < functions.size(); ++i) indexes.emplace(functions[i]->getName(), i);
+
+    static const Symbol mainName = Symbol::intern("main");
+    std::vector<bool> reached(functions.size(), false);
+    std::vector<size_t> work;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (functions[i]->getVisibility() != IttVisibility::PRIVATE || functions[i]->getName() == mainName) {
+            reached[i] = true;
+            work.push_back(i);
+        }
+    }
+
+    while (!work.empty()) {
+        size_t caller = work.back();
+        work.pop_back();
+        for (Symbol name : callees(caller)) {
+            auto callee = indexes.find(name);
+            if (callee != indexes.end() && !reached[callee->second]) {
+                reached[callee->second] = true;
+                work.push_back(callee->second);
+            }
+        }
+    }
+    return reached;
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dead_code.h"
+
+// Functions of locals that each read one of a few earlier ones, so most
+// definitions are dead, with a return three quarters of the way through.
+// Every fourth function is public; the others call into the next function
+// or are never called.
+static IttFunctionNode* generateFunction(Arena& arena, int index, int functions, int statements) {
+    Symbol parameter = Symbol::intern("input");
+    auto local = [](int i) { return Symbol::intern("local_" + std::to_string(i)); };
+
+    std::vector<IttNode*> body;
+    for (int i = 0; i < statements; ++i) {
+        IttNode* read = i < 4 ? static_cast<IttNode*>(arena.make<IttIdentifierNode>(parameter))
+                              : arena.make<IttIdentifierNode>(local(i - 1 - (i * 7 + index) % 4));
+        IttNode* value = arena.make<IttBinaryOperationNode>(read, arena.make<IttIntegerNode>(i), IttBinaryOperation::ADD);
+        if (i == statements * 3 / 4) {
+            if (index % 2 == 0 && index + 1 < functions) {
+                auto args = arena.copy(std::vector<IttNode*>{value});
+                value = arena.make<IttCallNode>(Symbol::intern("generated_" + std::to_string(index + 1)), args);
+            }
+            body.push_back(arena.make<IttReturnNode>(value));
+        } else {
+            body.push_back(arena.make<IttVariableNode>(local(i), value));
+        }
+    }
+
+    std::vector<std::pair<Symbol, IttType>> params = {{parameter, IttType(IttType::INT)}};
+    IttVisibility visibility = index % 4 == 0 ? IttVisibility::PUBLIC : IttVisibility::PRIVATE;
+    return arena.make<IttFunctionNode>(Symbol::intern("generated_" + std::to_string(index)), arena.copy(params),
+                                       IttType(IttType::INT), arena.make<IttBlockNode>(arena.copy(body)), visibility);
+}
+
+static size_t countStatements(const std::vector<IttFunctionNode*>& functions) {
+    size_t count = 0;
+    for (const IttFunctionNode* function : functions) {
+        count += static_cast<IttBlockNode&>(function->getBody()).getStatements().size();
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    int functionCount = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int statements = argc > 2 ? std::stoi(argv[2]) : 200;
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    Arena arena;
+    std::vector<IttFunctionNode*> program;
+    for (int i = 0; i < functionCount; ++i) program.push_back(generateFunction(arena, i, functionCount, statements));
+    size_t before = countStatements(program);
+
+    double best = 1e100;
+    size_t after = 0, kept = 0, unreachable = 0, unused = 0, pruned = 0;
+    for (int i = 0; i < iterations; ++i) {
+        Arena output;
+        DeadCodeEliminator eliminator(output);
+        std::vector<IttFunctionNode*> result = program;
+        auto start = std::chrono::steady_clock::now();
+        eliminator.prune(result);
+        for (IttFunctionNode*& function : result) function = eliminator.run(*function);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+
+        after = countStatements(result);
+        kept = result.size();
+        unreachable = eliminator.unreachableStatements();
+        unused = eliminator.unusedVariables();
+        pruned = eliminator.prunedFunctions();
+    }
+
+    std::cout << "statements:     " << before << " -> " << after << " in " << program.size() << " -> " << kept
+              << " functions\n";
+    std::cout << "eliminate:      " << best * 1000 << " ms (" << best / before * 1e9 << " ns/statement)\n";
+    std::cout << "removed:        " << unreachable << " unreachable, " << unused << " unused, " << pruned
+              << " functions\n";
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "../itt_test_helpers.h"
+#include "dead_code.h"
+
+static Span<IttNode*> statements(const IttFunctionNode& function) {
+    return static_cast<IttBlockNode&>(function.getBody()).getStatements();
+}
+
+TEST(DeadCodeTest, DropsStatementsAfterReturnTest) {
+    Arena arena;
+    DeadCodeEliminator eliminator(arena);
+    auto& function = *eliminator.run(*translated("fn f(x Int) -> Int { ret x; y = 1; ret y; }", arena)[0]);
+
+    ASSERT_EQ(statements(function).size(), 1u);
+    EXPECT_EQ(statements(function)[0]->getKind(), IttKind::RETURN);
+    EXPECT_EQ(eliminator.unreachableStatements(), 2u);
+    EXPECT_EQ(eliminator.unusedVariables(), 0u);
+}
+
+TEST(DeadCodeTest, DropsUnusedVariablesTest) {
+    Arena arena;
+    DeadCodeEliminator eliminator(arena);
+    auto& function = *eliminator.run(*translated(
+        "fn f(x Int) -> Int { a = 5; a = x + 1; b = x * 2; a = a + 3; c = a; ret a; }", arena)[0]);
+
+    // a = 5 is overwritten unread; b and c are never read.
+    auto kept = statements(function);
+    ASSERT_EQ(kept.size(), 3u);
+    EXPECT_EQ(static_cast<IttVariableNode&>(*kept[0]).getContent().getKind(), IttKind::BINARY_OPERATION);
+    EXPECT_EQ(kept[1]->getKind(), IttKind::VARIABLE);
+    EXPECT_EQ(kept[2]->getKind(), IttKind::RETURN);
+    EXPECT_EQ(eliminator.unusedVariables(), 3u);
+
+    // Dropping z leaves y unread, which the same sweep sees.
+    DeadCodeEliminator chain(arena);
+    auto& chained = *chain.run(*translated("fn g(x Int) -> Int { y = x; z = y; ret x; }", arena)[0]);
+    EXPECT_EQ(statements(chained).size(), 1u);
+    EXPECT_EQ(chain.unusedVariables(), 2u);
+}
+
+TEST(DeadCodeTest, KeepsCallsOfUnusedVariablesTest) {
+    Arena arena;
+    DeadCodeEliminator eliminator(arena);
+    auto& function = *eliminator.run(*translated("fn g(x Int) -> Int { y = f(x); z = x + 1; ret x; }", arena)[0]);
+
+    // y is never read, but f may have side effects; z goes entirely.
+    auto kept = statements(function);
+    ASSERT_EQ(kept.size(), 2u);
+    auto* call = ittCast<IttCallNode>(*kept[0]);
+    ASSERT_NE(call, nullptr);
+    EXPECT_EQ(call->getCallee(), "f");
+    EXPECT_EQ(kept[1]->getKind(), IttKind::RETURN);
+    EXPECT_EQ(eliminator.unusedVariables(), 2u);
+}
+
+TEST(DeadCodeTest, NestedBlockReturnsTest) {
+    Arena arena;
+    auto x = Symbol::intern("x");
+    std::vector<IttNode*> inner = {arena.make<IttVariableNode>(x, arena.make<IttIntegerNode>(1)),
+                                   arena.make<IttReturnNode>(arena.make<IttIdentifierNode>(x))};
+    std::vector<IttNode*> outer = {arena.make<IttVariableNode>(x, arena.make<IttIntegerNode>(0)),
+                                   arena.make<IttBlockNode>(arena.copy(inner)),
+                                   arena.make<IttReturnNode>(arena.make<IttIntegerNode>(2))};
+    IttFunctionNode function(Symbol::intern("nested"), {}, IttType(IttType::INT), arena.make<IttBlockNode>(arena.copy(outer)));
+
+    DeadCodeEliminator eliminator(arena);
+    auto kept = statements(*eliminator.run(function));
+    ASSERT_EQ(kept.size(), 1u);
+    EXPECT_EQ(static_cast<IttBlockNode&>(*kept[0]).getStatements().size(), 2u);
+    EXPECT_EQ(eliminator.unreachableStatements(), 1u);
+    EXPECT_EQ(eliminator.unusedVariables(), 1u);
+}
+
+TEST(DeadCodeTest, SharesLiveFunctionsTest) {
+    Arena arena;
+    DeadCodeEliminator eliminator(arena);
+    auto& function = *translated("fn f(x Int) -> Int { y = x + 1; report(y); ret y * x; }", arena)[0];
+
+    EXPECT_EQ(eliminator.run(function), &function);
+    EXPECT_EQ(eliminator.unreachableStatements() + eliminator.unusedVariables(), 0u);
+}
+
+TEST(DeadCodeTest, PrunesUnreachedPrivateFunctionsTest) {
+    Arena arena;
+    auto functions = translated(
+        "pub fn api() -> Int { ret helper(1); }\n"
+        "fn helper(x Int) -> Int { ret x + leaf(); }\n"
+        "fn leaf() -> Int { ret 2; }\n"
+        "fn orphan() -> Int { ret leaf() + orphan(); }\n"
+        "fn main() -> Int { ret 0; }\n"
+        "fn unused() -> Int { ret orphan(); }\n",
+        arena);
+
+    DeadCodeEliminator eliminator(arena);
+    eliminator.prune(functions);
+
+    ASSERT_EQ(functions.size(), 4u);
+    EXPECT_EQ(functions[0]->getName(), "api");
+    EXPECT_EQ(functions[1]->getName(), "helper");
+    EXPECT_EQ(functions[2]->getName(), "leaf");
+    EXPECT_EQ(functions[3]->getName(), "main");
+    EXPECT_EQ(eliminator.prunedFunctions(), 2u);
+}
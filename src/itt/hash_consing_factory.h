@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "itt.h"
+
+// Builds ITT expression nodes so that structurally equal ones are one node:
+// make<T> returns the existing node when an equal one was made before.
+// Children must come from the same factory, so two candidates are equal
+// exactly when their payloads and child pointers are.
+//
+// Only literals, identifiers and unary and binary operations are shared; they have no
+// side effects and are never changed after construction apart from their
+// resolved type. A shared identifier carries one type, so keep a factory to
+// a scope in which every name has one meaning, e.g. clear it per function.
+class HashConsingFactory {
+    Arena& _arena;
+    // Open addressing with linear probing; size is a power of two.
+    std::vector<IttNode*> _slots;
+    // Filled slots, so clear() costs as much as the nodes made, not the table.
+    std::vector<uint32_t> _used;
+    size_t _hits;
+
+    static uint32_t floatBits(const IttFloatNode& node) {
+        float value = node.getValue();
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static bool sameNode(const IttNode& a, const IttNode& b) {
+        if (a.structuralHash() != b.structuralHash() || a.getKind() != b.getKind()) return false;
+
+        switch (a.getKind()) {
+            case IttKind::INTEGER:
+                return static_cast<const IttIntegerNode&>(a).getValue() == static_cast<const IttIntegerNode&>(b).getValue();
+            case IttKind::FLOAT:
+                // By bits: 0.0 and -0.0 compare equal but are different
+                // literals, and a NaN is one literal with itself.
+                return floatBits(static_cast<const IttFloatNode&>(a)) == floatBits(static_cast<const IttFloatNode&>(b));
+            case IttKind::BOOLEAN:
+                return static_cast<const IttBooleanNode&>(a).getValue() == static_cast<const IttBooleanNode&>(b).getValue();
+            case IttKind::CHAR:
+                return static_cast<const IttCharNode&>(a).getValue() == static_cast<const IttCharNode&>(b).getValue();
+            case IttKind::IDENTIFIER:
+                return static_cast<const IttIdentifierNode&>(a).getName() == static_cast<const IttIdentifierNode&>(b).getName();
+            case IttKind::BINARY_OPERATION: {
+                auto& x = static_cast<const IttBinaryOperationNode&>(a);
+                auto& y = static_cast<const IttBinaryOperationNode&>(b);
+                return x.getOperation() == y.getOperation() && &x.getLhs() == &y.getLhs() && &x.getRhs() == &y.getRhs();
+            }
+            case IttKind::UNARY_OPERATION: {
+                auto& x = static_cast<const IttUnaryOperationNode&>(a);
+                auto& y = static_cast<const IttUnaryOperationNode&>(b);
+                return x.getOperation() == y.getOperation() && &x.getOperand() == &y.getOperand();
+            }
+            default:
+                return false;
+        }
+    }
+
+    void grow() {
+        std::vector<IttNode*> old(_slots.size() * 2, nullptr);
+        old.swap(_slots);
+        _used.clear();
+        for (IttNode* node : old) {
+            if (node) insert(node);
+        }
+    }
+
+    void insert(IttNode* node) {
+        size_t mask = _slots.size() - 1;
+        size_t slot = node->structuralHash() & mask;
+        while (_slots[slot]) slot = (slot + 1) & mask;
+        _slots[slot] = node;
+        _used.push_back(static_cast<uint32_t>(slot));
+    }
+
+public:
+    explicit HashConsingFactory(Arena& arena, size_t capacity = 1024)
+        : _arena(arena), _slots(capacity), _hits(0) {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("HashConsingFactory capacity must be a power of two");
+        }
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_same_v<T, IttIntegerNode> || std::is_same_v<T, IttFloatNode> ||
+                          std::is_same_v<T, IttBooleanNode> || std::is_same_v<T, IttCharNode> ||
+                          std::is_same_v<T, IttIdentifierNode> || std::is_same_v<T, IttBinaryOperationNode> ||
+                          std::is_same_v<T, IttUnaryOperationNode>,
+                      "only side-effect-free expression nodes are shared");
+
+        // Built on the stack first, which computes its hash; it is copied
+        // into the arena only if no equal node exists yet.
+        T candidate(std::forward<Args>(args)...);
+
+        size_t mask = _slots.size() - 1;
+        for (size_t slot = candidate.structuralHash() & mask; _slots[slot]; slot = (slot + 1) & mask) {
+            if (sameNode(*_slots[slot], candidate)) {
+                _hits++;
+                return static_cast<T*>(_slots[slot]);
+            }
+        }
+
+        if ((_used.size() + 1) * 4 > _slots.size() * 3) {
+            grow();
+        }
+
+        T* node = _arena.make<T>(candidate);
+        insert(node);
+        return node;
+    }
+
+    // Forgets the shared nodes; they stay valid in the arena.
+    void clear() {
+        for (uint32_t slot : _used) _slots[slot] = nullptr;
+        _used.clear();
+    }
+
+    // Distinct nodes currently shared, and how many make calls reused one.
+    size_t size() const { return _used.size(); }
+    size_t hits() const { return _hits; }
+};
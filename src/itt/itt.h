@@ -1,28 +1,75 @@
 #pragma once
-#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <tuple>
+#include <type_traits>
 #include <vector>
-#include<optional>
 
+#include "../utilities/arena/arena.h"
+#include "../utilities/interner/string_interner.h"
 #include "itt_type.h"
 
+// Concrete node class of an IttNode, so passes can dispatch with a switch
+// (see visitItt) and compare or cast without RTTI.
+enum class IttKind : uint8_t {
+    BINARY_OPERATION,
+    VARIABLE,
+    FUNCTION,
+    BLOCK,
+    INTEGER,
+    IDENTIFIER,
+    FLOAT,
+    BOOLEAN,
+    CHAR,
+    RETURN,
+    CALL,
+    UNARY_OPERATION
+};
+
+// Nodes are built in an Arena and released with it, so they are trivially
+// destructible: children are plain pointers or spans into the same arena.
 class IttNode {
   protected:
     IttType _type;
+    const IttKind _kind;
+    uint32_t _hash;
+
+    ~IttNode() = default;
+
+    // Folds one field into the structural hash; constructors call this for
+    // their payload and their children's hashes.
+    void hashIn(uint64_t value) {
+        uint64_t h = value + 0x9E3779B97F4A7C15ull + (uint64_t(_hash) << 6) + (_hash >> 2);
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        _hash = static_cast<uint32_t>(h ^ (h >> 31));
+    }
 
   public:
-    explicit IttNode() : _type(IttType::UNRESOLVED) {}
-    virtual ~IttNode() = default;
+    explicit IttNode(IttKind kind) : _type(IttType::UNRESOLVED), _kind(kind), _hash(static_cast<uint32_t>(kind)) {}
 
     IttType getType() const { return _type; }
     void setType(IttType type) { this->_type = type; }
 
+    IttKind getKind() const { return _kind; }
+
+    // Agrees with ittEquals: equal trees hash alike, resolved types are
+    // ignored. Fixed at construction from the children's cached hashes, so
+    // it costs nothing to read.
+    uint32_t structuralHash() const { return _hash; }
+
     virtual void accept(class IttVisitor& visitor) = 0;
-    virtual bool operator==(const IttNode& other) const = 0;
+
+    // Structural equality; see ittEquals.
+    bool operator==(const IttNode& other) const;
 };
 
 class IttVisitor {
   public:
     virtual void visit(class IttBinaryOperationNode& node) = 0;
+    virtual void visit(class IttUnaryOperationNode& node) = 0;
     virtual void visit(class IttVariableNode& node) = 0;
     virtual void visit(class IttFunctionNode& node) = 0;
     virtual void visit(class IttBlockNode& node) = 0;
@@ -32,6 +79,7 @@ class IttVisitor {
     virtual void visit(class IttBooleanNode& node) = 0;
     virtual void visit(class IttCharNode& node) = 0;
     virtual void visit(class IttReturnNode& node) = 0;
+    virtual void visit(class IttCallNode& node) = 0;
 };
 
 enum class IttVisibility {
@@ -44,36 +92,24 @@ class IttIntegerNode : public IttNode {
   int _value;
 
   public:
-    IttIntegerNode(int value) : IttNode(), _value(value) {}
+    static constexpr IttKind kind = IttKind::INTEGER;
+    IttIntegerNode(int value) : IttNode(IttKind::INTEGER), _value(value) { hashIn(static_cast<uint32_t>(value)); }
 
     int getValue() const { return _value; }
 
     void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-    bool operator==(const IttNode& other) const override {
-        if (const IttIntegerNode* otherIntNode = dynamic_cast<const IttIntegerNode*>(&other)) {
-            return this->_value == otherIntNode->_value;
-        }
-        return false;
-    }
 };
 
 
 class IttIdentifierNode : public IttNode {
-  std::string _name;
+  Symbol _name;
 public:
-  IttIdentifierNode(std::string name): IttNode(), _name(name) {}
+  static constexpr IttKind kind = IttKind::IDENTIFIER;
+  IttIdentifierNode(Symbol name): IttNode(IttKind::IDENTIFIER), _name(name) { hashIn(name.getId()); }
 
-  std::string getName() const { return _name; }
+  Symbol getName() const { return _name; }
 
   void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-  bool operator==(const IttNode& other) const override {
-      if (const IttIdentifierNode* otherIdNode = dynamic_cast<const IttIdentifierNode*>(&other)) {
-          return this->_name == otherIdNode->_name;
-      }
-      return false;
-  }
 };
 
 
@@ -81,54 +117,41 @@ class IttFloatNode : public IttNode {
   float _value;
 
   public:
-  IttFloatNode(float value): IttNode(), _value(value) {}
+  static constexpr IttKind kind = IttKind::FLOAT;
+  IttFloatNode(float value): IttNode(IttKind::FLOAT), _value(value) {
+      // 0.0f == -0.0f, so both hash as +0.
+      uint32_t bits = 0;
+      if (value != 0) memcpy(&bits, &value, sizeof(bits));
+      hashIn(bits);
+  }
 
   float getValue() const { return _value; }
 
   void accept(IttVisitor& visitor) override { visitor.visit(*this); };
-
-  bool operator==(const IttNode& other) const override {
-      if (const IttFloatNode* otherFloatNode = dynamic_cast<const IttFloatNode*>(&other)) {
-          return this->_value == otherFloatNode->_value;
-      }
-      return false;
-  }
 };
 
 class IttBooleanNode : public IttNode {
   bool _value;
 
   public:
-  IttBooleanNode(bool value): IttNode(), _value(value) {}
+  static constexpr IttKind kind = IttKind::BOOLEAN;
+  IttBooleanNode(bool value): IttNode(IttKind::BOOLEAN), _value(value) { hashIn(value); }
 
   bool getValue() const { return _value; }
 
   void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-  bool operator==(const IttNode& other) const override {
-      if (const IttBooleanNode* otherBoolNode = dynamic_cast<const IttBooleanNode*>(&other)) {
-          return this->_value == otherBoolNode->_value;
-      }
-      return false;
-  }
 };
 
 class IttCharNode : public IttNode {
   char _value;
 
   public:
-  IttCharNode(char value): IttNode(), _value(value) {}
+  static constexpr IttKind kind = IttKind::CHAR;
+  IttCharNode(char value): IttNode(IttKind::CHAR), _value(value) { hashIn(static_cast<unsigned char>(value)); }
 
   char getValue() const { return _value; }
 
   void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-  bool operator==(const IttNode& other) const override {
-      if (const IttCharNode* otherCharNode = dynamic_cast<const IttCharNode*>(&other)) {
-          return this->_value == otherCharNode->_value;
-      }
-      return false;
-  }
 };
 
 enum class IttBinaryOperation {
@@ -140,129 +163,325 @@ enum class IttBinaryOperation {
     OR,
     LESS_THEN,
     GREATER_THEN,
-    EQUALS
+    EQUALS,
+    LESS_EQUALS,
+    GREATER_EQUALS,
+    NOT_EQUALS,
+    // Int only; produced by strength reduction, not by the source.
+    SHL
 };
 
 class IttBinaryOperationNode : public IttNode {
-    std::shared_ptr<IttNode> _lhs;
-    std::shared_ptr<IttNode> _rhs;
+    IttNode* _lhs;
+    IttNode* _rhs;
     IttBinaryOperation _op;
 
   public:
+    static constexpr IttKind kind = IttKind::BINARY_OPERATION;
     IttBinaryOperationNode(
-        std::shared_ptr<IttNode> lhs,
-        std::shared_ptr<IttNode> rhs,
+        IttNode* lhs,
+        IttNode* rhs,
         IttBinaryOperation op)
-        : IttNode(), _lhs(lhs), _rhs(rhs), _op(op) {}
+        : IttNode(IttKind::BINARY_OPERATION), _lhs(lhs), _rhs(rhs), _op(op) {
+        hashIn(static_cast<uint64_t>(op));
+        hashIn(lhs->structuralHash());
+        hashIn(rhs->structuralHash());
+    }
 
     IttNode& getLhs() const { return *_lhs; }
     IttNode& getRhs() const { return *_rhs; }
     IttBinaryOperation getOperation() const { return _op; }
 
     void accept(IttVisitor& visitor) override { visitor.visit(*this); }
+};
 
-    bool operator==(const IttNode& other) const override {
-        if (const IttBinaryOperationNode* otherOpNode = dynamic_cast<const IttBinaryOperationNode*>(&other)) {
-            return this->_op == otherOpNode->_op &&
-                  *this->_lhs == *otherOpNode->_lhs &&
-                  *this->_rhs == *otherOpNode->_rhs;
-        }
-        return false;
+enum class IttUnaryOperation {
+    // Int or Float; on a Float it flips the sign bit, so -0.0 and NaN are
+    // exact, unlike 0.0 - x.
+    NEG
+};
+
+class IttUnaryOperationNode : public IttNode {
+    IttNode* _operand;
+    IttUnaryOperation _op;
+
+  public:
+    static constexpr IttKind kind = IttKind::UNARY_OPERATION;
+    IttUnaryOperationNode(IttNode* operand, IttUnaryOperation op)
+        : IttNode(IttKind::UNARY_OPERATION), _operand(operand), _op(op) {
+        hashIn(static_cast<uint64_t>(op));
+        hashIn(operand->structuralHash());
     }
+
+    IttNode& getOperand() const { return *_operand; }
+    IttUnaryOperation getOperation() const { return _op; }
+
+    void accept(IttVisitor& visitor) override { visitor.visit(*this); }
 };
 
 class IttVariableNode : public IttNode {
-    std::string _name;
-    std::shared_ptr<IttNode> _attachedContent;
+    Symbol _name;
+    IttNode* _attachedContent;
   public:
-    IttVariableNode(const std::string& name, std::shared_ptr<IttNode> attached)
-        : IttNode(), _name(name), _attachedContent(attached) {}
+    static constexpr IttKind kind = IttKind::VARIABLE;
+    IttVariableNode(Symbol name, IttNode* attached)
+        : IttNode(IttKind::VARIABLE), _name(name), _attachedContent(attached) {
+        hashIn(name.getId());
+        hashIn(attached->structuralHash());
+    }
 
-    const std::string& getName() const { return _name; }
+    Symbol getName() const { return _name; }
 
     IttNode& getContent() const { return *_attachedContent; }
 
     void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-    bool operator==(const IttNode& other) const override {
-        if (const IttVariableNode* otherVarNode = dynamic_cast<const IttVariableNode*>(&other)) {
-            return this->_name == otherVarNode->_name && *this->_attachedContent == *otherVarNode->_attachedContent;
-        }
-        return false;
-    }
 };
 
 class IttFunctionNode : public IttNode {
-    std::string _name;
-    std::vector<std::pair<std::string, IttType>> _parameters;
-    std::shared_ptr<IttNode> _body;
+    Symbol _name;
+    Span<std::pair<Symbol, IttType>> _parameters;
+    IttType _returnType;
+    IttNode* _body;
+    IttVisibility _visibility;
 
   public:
+    static constexpr IttKind kind = IttKind::FUNCTION;
     IttFunctionNode(
-        const std::string& name,
-        std::vector<std::pair<std::string, IttType>> parameters,
-        std::shared_ptr<IttNode> body)
-        : IttNode(), _name(name), _parameters(parameters), _body(body) {}
+        Symbol name,
+        Span<std::pair<Symbol, IttType>> parameters,
+        IttType returnType,
+        IttNode* body,
+        IttVisibility visibility = IttVisibility::PRIVATE)
+        : IttNode(IttKind::FUNCTION), _name(name), _parameters(parameters), _returnType(returnType), _body(body),
+          _visibility(visibility) {
+        // Parameter and return types stay out: type inference resolves the
+        // parameters in place, after the hash is fixed.
+        hashIn(name.getId());
+        hashIn(static_cast<uint64_t>(visibility));
+        for (const auto& parameter : parameters) {
+            hashIn(parameter.first.getId());
+        }
+        hashIn(body->structuralHash());
+    }
 
-    const std::string& getName() const { return _name; }
-    const std::vector<std::pair<std::string, IttType>>& getParameters() const { return _parameters; }
+    Symbol getName() const { return _name; }
+    // Declared signature; UNRESOLVED where the source names no built-in type.
+    // Type inference fills those in, and sets the node's own type to the
+    // return type.
+    Span<std::pair<Symbol, IttType>> getParameters() const { return _parameters; }
+    IttType getReturnType() const { return _returnType; }
     IttNode& getBody() const { return *_body; }
+    // Private functions can only be called from within the module.
+    IttVisibility getVisibility() const { return _visibility; }
 
     void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-    bool operator==(const IttNode& other) const override {
-        if (const IttFunctionNode* otherFuncNode = dynamic_cast<const IttFunctionNode*>(&other)) {
-            return this->_name == otherFuncNode->_name &&
-                    this->_parameters == otherFuncNode->_parameters &&
-                    *this->_body == *otherFuncNode->_body;
-        }
-        return false;
-    }
 };
 
 class IttBlockNode : public IttNode {
-    std::vector<std::shared_ptr<IttNode>> _statements;
+    Span<IttNode*> _statements;
 
   public:
-    IttBlockNode(std::vector<std::shared_ptr<IttNode>>& statements)
-        : IttNode(), _statements(statements) {}
+    static constexpr IttKind kind = IttKind::BLOCK;
+    IttBlockNode(Span<IttNode*> statements)
+        : IttNode(IttKind::BLOCK), _statements(statements) {
+        for (IttNode* statement : statements) {
+            hashIn(statement->structuralHash());
+        }
+    }
 
-    std::vector<std::shared_ptr<IttNode>>& getStatements() {
+    Span<IttNode*> getStatements() const {
         return _statements;
     }
 
 
     void accept(IttVisitor& visitor) override { visitor.visit(*this); }
-
-  bool operator==(const IttNode& other) const override {
-      if (const IttBlockNode* otherBlockNode = dynamic_cast<const IttBlockNode*>(&other)) {
-          if (_statements.size() != otherBlockNode->_statements.size()) return false;
-          for (size_t i = 0; i < _statements.size(); ++i) {
-              if (!(*_statements[i] == *otherBlockNode->_statements[i])) return false;
-          }
-          return true;
-      }
-      return false;
-  }
 };
 
 class IttReturnNode : public IttNode {
-  std::optional<std::shared_ptr<IttNode>> _attachedContent;
+  IttNode* _attachedContent;
 
   public: 
-  IttReturnNode(std::optional<std::shared_ptr<IttNode>> attached) : IttNode(), _attachedContent(attached) {}
+  static constexpr IttKind kind = IttKind::RETURN;
+  // attached is null for a bare "ret;".
+  IttReturnNode(IttNode* attached) : IttNode(IttKind::RETURN), _attachedContent(attached) {
+      if (attached) hashIn(attached->structuralHash());
+  }
 
-  const std::optional<std::shared_ptr<IttNode>>& getReturnStmt() const { return _attachedContent; }
+  std::optional<IttNode*> getReturnStmt() const {
+      if (_attachedContent) {
+          return _attachedContent;
+      }
+      return std::nullopt;
+  }
 
   void accept(IttVisitor& visitor) override { visitor.visit(*this); }
+};
 
-  bool operator==(const IttNode& other) const override {
-      if (const IttReturnNode* otherReturnNode = dynamic_cast<const IttReturnNode*>(&other)) {
-          if (this->_attachedContent && otherReturnNode->_attachedContent) {
-              return *this->_attachedContent == *otherReturnNode->_attachedContent;
-          }
-          return !this->_attachedContent && !otherReturnNode->_attachedContent;
-      }
-      return false;
-  }
-};
\ No newline at end of file
+// A call of a function of the same module by name. The callee may be
+// extern, and so may have side effects: passes keep every call they see.
+class IttCallNode : public IttNode {
+    Symbol _callee;
+    Span<IttNode*> _arguments;
+
+  public:
+    static constexpr IttKind kind = IttKind::CALL;
+    IttCallNode(Symbol callee, Span<IttNode*> arguments)
+        : IttNode(IttKind::CALL), _callee(callee), _arguments(arguments) {
+        hashIn(callee.getId());
+        for (IttNode* argument : arguments) {
+            hashIn(argument->structuralHash());
+        }
+    }
+
+    Symbol getCallee() const { return _callee; }
+    Span<IttNode*> getArguments() const { return _arguments; }
+
+    void accept(IttVisitor& visitor) override { visitor.visit(*this); }
+};
+
+// The node as T if it is one, without RTTI.
+template <typename T>
+T* ittCast(IttNode& node) {
+    return node.getKind() == T::kind ? static_cast<T*>(&node) : nullptr;
+}
+
+template <typename T>
+const T* ittCast(const IttNode& node) {
+    return node.getKind() == T::kind ? static_cast<const T*>(&node) : nullptr;
+}
+
+// Calls f with node downcast to its concrete class, chosen by a switch over
+// the kind tag; f is typically a generic lambda or an overload set. A
+// non-virtual alternative to IttVisitor for passes.
+template <typename T, typename Node>
+using IttDowncast = std::conditional_t<std::is_const_v<Node>, const T&, T&>;
+
+template <typename Node, typename F>
+decltype(auto) visitItt(Node& node, F&& f) {
+    static_assert(std::is_same_v<std::remove_const_t<Node>, IttNode>, "visitItt takes an IttNode");
+    switch (node.getKind()) {
+        case IttKind::BINARY_OPERATION: return f(static_cast<IttDowncast<IttBinaryOperationNode, Node>>(node));
+        case IttKind::UNARY_OPERATION: return f(static_cast<IttDowncast<IttUnaryOperationNode, Node>>(node));
+        case IttKind::VARIABLE: return f(static_cast<IttDowncast<IttVariableNode, Node>>(node));
+        case IttKind::FUNCTION: return f(static_cast<IttDowncast<IttFunctionNode, Node>>(node));
+        case IttKind::BLOCK: return f(static_cast<IttDowncast<IttBlockNode, Node>>(node));
+        case IttKind::INTEGER: return f(static_cast<IttDowncast<IttIntegerNode, Node>>(node));
+        case IttKind::IDENTIFIER: return f(static_cast<IttDowncast<IttIdentifierNode, Node>>(node));
+        case IttKind::FLOAT: return f(static_cast<IttDowncast<IttFloatNode, Node>>(node));
+        case IttKind::BOOLEAN: return f(static_cast<IttDowncast<IttBooleanNode, Node>>(node));
+        case IttKind::CHAR: return f(static_cast<IttDowncast<IttCharNode, Node>>(node));
+        case IttKind::RETURN: return f(static_cast<IttDowncast<IttReturnNode, Node>>(node));
+        case IttKind::CALL: return f(static_cast<IttDowncast<IttCallNode, Node>>(node));
+    }
+    __builtin_unreachable();
+}
+
+// Structural equality, ignoring resolved types. Walks both trees in
+// lockstep with an explicit stack: each pair is compared by tag and payload,
+// and its children are pushed instead of recursed into. Differing cached
+// hashes end the walk early, and shared subtrees are not descended into.
+inline bool ittEquals(const IttNode& lhs, const IttNode& rhs) {
+    std::vector<std::pair<const IttNode*, const IttNode*>> pending;
+    const IttNode* a = &lhs;
+    const IttNode* b = &rhs;
+
+    for (;;) {
+        if (a != b) {
+            if (a->structuralHash() != b->structuralHash() || a->getKind() != b->getKind()) return false;
+
+            switch (a->getKind()) {
+                case IttKind::INTEGER:
+                    if (static_cast<const IttIntegerNode*>(a)->getValue() != static_cast<const IttIntegerNode*>(b)->getValue()) return false;
+                    break;
+                case IttKind::FLOAT:
+                    if (static_cast<const IttFloatNode*>(a)->getValue() != static_cast<const IttFloatNode*>(b)->getValue()) return false;
+                    break;
+                case IttKind::BOOLEAN:
+                    if (static_cast<const IttBooleanNode*>(a)->getValue() != static_cast<const IttBooleanNode*>(b)->getValue()) return false;
+                    break;
+                case IttKind::CHAR:
+                    if (static_cast<const IttCharNode*>(a)->getValue() != static_cast<const IttCharNode*>(b)->getValue()) return false;
+                    break;
+                case IttKind::IDENTIFIER:
+                    if (static_cast<const IttIdentifierNode*>(a)->getName() != static_cast<const IttIdentifierNode*>(b)->getName()) return false;
+                    break;
+                case IttKind::BINARY_OPERATION: {
+                    auto x = static_cast<const IttBinaryOperationNode*>(a);
+                    auto y = static_cast<const IttBinaryOperationNode*>(b);
+                    if (x->getOperation() != y->getOperation()) return false;
+                    pending.emplace_back(&x->getRhs(), &y->getRhs());
+                    a = &x->getLhs();
+                    b = &y->getLhs();
+                    continue;
+                }
+                case IttKind::UNARY_OPERATION: {
+                    auto x = static_cast<const IttUnaryOperationNode*>(a);
+                    auto y = static_cast<const IttUnaryOperationNode*>(b);
+                    if (x->getOperation() != y->getOperation()) return false;
+                    a = &x->getOperand();
+                    b = &y->getOperand();
+                    continue;
+                }
+                case IttKind::VARIABLE: {
+                    auto x = static_cast<const IttVariableNode*>(a);
+                    auto y = static_cast<const IttVariableNode*>(b);
+                    if (x->getName() != y->getName()) return false;
+                    a = &x->getContent();
+                    b = &y->getContent();
+                    continue;
+                }
+                case IttKind::FUNCTION: {
+                    auto x = static_cast<const IttFunctionNode*>(a);
+                    auto y = static_cast<const IttFunctionNode*>(b);
+                    auto xParams = x->getParameters();
+                    auto yParams = y->getParameters();
+                    if (x->getName() != y->getName() || !(x->getReturnType() == y->getReturnType()) ||
+                        x->getVisibility() != y->getVisibility() ||
+                        xParams.size() != yParams.size() ||
+                        !std::equal(xParams.begin(), xParams.end(), yParams.begin())) return false;
+                    a = &x->getBody();
+                    b = &y->getBody();
+                    continue;
+                }
+                case IttKind::BLOCK: {
+                    auto x = static_cast<const IttBlockNode*>(a)->getStatements();
+                    auto y = static_cast<const IttBlockNode*>(b)->getStatements();
+                    if (x.size() != y.size()) return false;
+                    for (size_t i = x.size(); i-- > 0;) {
+                        pending.emplace_back(x[i], y[i]);
+                    }
+                    break;
+                }
+                case IttKind::CALL: {
+                    auto x = static_cast<const IttCallNode*>(a);
+                    auto y = static_cast<const IttCallNode*>(b);
+                    if (x->getCallee() != y->getCallee()) return false;
+                    auto xArgs = x->getArguments();
+                    auto yArgs = y->getArguments();
+                    if (xArgs.size() != yArgs.size()) return false;
+                    for (size_t i = xArgs.size(); i-- > 0;) {
+                        pending.emplace_back(xArgs[i], yArgs[i]);
+                    }
+                    break;
+                }
+                case IttKind::RETURN: {
+                    auto x = static_cast<const IttReturnNode*>(a)->getReturnStmt();
+                    auto y = static_cast<const IttReturnNode*>(b)->getReturnStmt();
+                    if (x.has_value() != y.has_value()) return false;
+                    if (x) {
+                        a = *x;
+                        b = *y;
+                        continue;
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (pending.empty()) return true;
+        std::tie(a, b) = pending.back();
+        pending.pop_back();
+    }
+}
+
+inline bool IttNode::operator==(const IttNode& other) const { return ittEquals(*this, other); }
@@ -0,0 +1,165 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "itt.h"
+#include "type_context.h"
+
+// A body of generated statements, each a small arithmetic tree over
+// literals and identifiers, nested depth levels deep.
+static IttNode* generateExpression(Arena& arena, int depth, int seed) {
+    if (depth == 0) {
+        switch (seed % 4) {
+            case 0: return arena.make<IttIntegerNode>(seed);
+            case 1: return arena.make<IttFloatNode>(seed * 0.5f);
+            case 2: return arena.make<IttBooleanNode>(seed % 3 == 0);
+            default: return arena.make<IttIdentifierNode>(Symbol::intern("value_" + std::to_string(seed % 64)));
+        }
+    }
+    static const IttBinaryOperation ops[] = {IttBinaryOperation::ADD, IttBinaryOperation::MUL, IttBinaryOperation::LESS_THEN};
+    return arena.make<IttBinaryOperationNode>(generateExpression(arena, depth - 1, seed * 3 + 1),
+                                              generateExpression(arena, depth - 1, seed * 3 + 2), ops[seed % 3]);
+}
+
+static IttNode* generateFunction(Arena& arena, int statements, int depth) {
+    std::vector<IttNode*> body;
+    for (int i = 0; i < statements; ++i) {
+        auto value = generateExpression(arena, depth, i);
+        if (i % 2 == 0) {
+            body.push_back(arena.make<IttVariableNode>(Symbol::intern("local_" + std::to_string(i % 16)), value));
+        } else {
+            body.push_back(arena.make<IttReturnNode>(value));
+        }
+    }
+    std::vector<std::pair<Symbol, IttType>> params = {{Symbol::intern("value_0"), IttType(IttType::INT)}};
+    return arena.make<IttFunctionNode>(Symbol::intern("generated"), arena.copy(params), IttType(IttType::INT),
+                                       arena.make<IttBlockNode>(arena.copy(body)));
+}
+
+// Counts nodes through the virtual visitor interface.
+class NodeCounter : public IttVisitor {
+public:
+    size_t count = 0;
+
+    void visit(IttBinaryOperationNode& node) override {
+        count++;
+        node.getLhs().accept(*this);
+        node.getRhs().accept(*this);
+    }
+    void visit(IttUnaryOperationNode& node) override {
+        count++;
+        node.getOperand().accept(*this);
+    }
+    void visit(IttVariableNode& node) override {
+        count++;
+        node.getContent().accept(*this);
+    }
+    void visit(IttFunctionNode& node) override {
+        count++;
+        node.getBody().accept(*this);
+    }
+    void visit(IttBlockNode& node) override {
+        count++;
+        for (auto& statement : node.getStatements()) statement->accept(*this);
+    }
+    void visit(IttIntegerNode&) override { count++; }
+    void visit(IttIdentifierNode&) override { count++; }
+    void visit(IttFloatNode&) override { count++; }
+    void visit(IttBooleanNode&) override { count++; }
+    void visit(IttCharNode&) override { count++; }
+    void visit(IttReturnNode& node) override {
+        count++;
+        if (node.getReturnStmt()) (*node.getReturnStmt())->accept(*this);
+    }
+    void visit(IttCallNode& node) override {
+        count++;
+        for (auto& argument : node.getArguments()) argument->accept(*this);
+    }
+};
+
+// Same count through the kind-tag switch.
+static size_t countNodes(const IttNode& node) {
+    return 1 + visitItt(node, [](const auto& concrete) -> size_t {
+        using Node = std::decay_t<decltype(concrete)>;
+        if constexpr (std::is_same_v<Node, IttBinaryOperationNode>) {
+            return countNodes(concrete.getLhs()) + countNodes(concrete.getRhs());
+        } else if constexpr (std::is_same_v<Node, IttVariableNode>) {
+            return countNodes(concrete.getContent());
+        } else if constexpr (std::is_same_v<Node, IttFunctionNode>) {
+            return countNodes(concrete.getBody());
+        } else if constexpr (std::is_same_v<Node, IttBlockNode>) {
+            size_t count = 0;
+            for (const auto& statement : concrete.getStatements()) count += countNodes(*statement);
+            return count;
+        } else if constexpr (std::is_same_v<Node, IttReturnNode>) {
+            return concrete.getReturnStmt() ? countNodes(**concrete.getReturnStmt()) : 0;
+        } else {
+            return 0;
+        }
+    });
+}
+
+template <typename F>
+static double bestOf(int iterations, F&& body) {
+    double best = 1e100;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int statements = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int depth = argc > 2 ? std::stoi(argv[2]) : 8;
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    Arena arena;
+    auto first = generateFunction(arena, statements, depth);
+    auto second = generateFunction(arena, statements, depth);
+
+    NodeCounter counter;
+    first->accept(counter);
+    size_t nodes = counter.count;
+
+    bool equal = false;
+    double equalitySeconds = bestOf(iterations, [&] { equal = *first == *second; });
+
+    size_t visited = 0;
+    double visitorSeconds = bestOf(iterations, [&] {
+        NodeCounter walk;
+        first->accept(walk);
+        visited = walk.count;
+    });
+
+    size_t switched = 0;
+    double switchSeconds = bestOf(iterations, [&] { switched = countNodes(*first); });
+
+    std::cout << "tree:           " << nodes << " nodes, depth " << depth << "\n";
+    std::cout << "deep equality:  " << equalitySeconds * 1000 << " ms (" << equalitySeconds / nodes * 1e9
+              << " ns/node)" << (equal ? "" : " MISMATCH") << "\n";
+    std::cout << "visitor walk:   " << visitorSeconds * 1000 << " ms (" << visitorSeconds / nodes * 1e9
+              << " ns/node)" << (visited == nodes ? "" : " MISMATCH") << "\n";
+    std::cout << "visitItt walk:  " << switchSeconds * 1000 << " ms (" << switchSeconds / nodes * 1e9
+              << " ns/node)" << (switched == nodes ? "" : " MISMATCH") << "\n";
+
+    // Signatures as a checker would build them: mostly ones seen before.
+    TypeContext types;
+    const int signatures = 1000000;
+    IttType lastSignature(IttType::UNRESOLVED);
+    std::vector<IttType> params;
+    double internSeconds = bestOf(iterations, [&] {
+        for (int i = 0; i < signatures; ++i) {
+            IttType element = types.arrayOf(IttType(IttType::CHAR), 1 + i % 64);
+            params.assign({IttType(IttType::INT), types.pointerTo(element)});
+            lastSignature = types.function(IttType(IttType::BOOL), params);
+        }
+    });
+    std::cout << "type interning: " << internSeconds / signatures * 1e9 << " ns/signature, " << types.size()
+              << " distinct types, last " << types.toString(lastSignature) << "\n";
+
+    return 0;
+}
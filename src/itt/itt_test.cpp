@@ -0,0 +1,196 @@
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include "hash_consing_factory.h"
+#include "itt.h"
+#include "type_context.h"
+
+static Arena arena;
+
+static IttNode* sum(IttNode* lhs, IttNode* rhs) {
+    return arena.make<IttBinaryOperationNode>(lhs, rhs, IttBinaryOperation::ADD);
+}
+
+static IttNode* integer(int value) { return arena.make<IttIntegerNode>(value); }
+
+TEST(IttTest, CastTest) {
+    auto node = integer(4);
+
+    ASSERT_EQ(node->getKind(), IttKind::INTEGER);
+    ASSERT_NE(ittCast<IttIntegerNode>(*node), nullptr);
+    ASSERT_EQ(ittCast<IttIntegerNode>(*node)->getValue(), 4);
+    ASSERT_EQ(ittCast<IttFloatNode>(*node), nullptr);
+}
+
+// Counts nodes and sums integer literals with one generic lambda.
+static void walk(const IttNode& node, size_t& count, int& total) {
+    count++;
+    visitItt(node, [&](const auto& concrete) {
+        using Node = std::decay_t<decltype(concrete)>;
+        if constexpr (std::is_same_v<Node, IttIntegerNode>) {
+            total += concrete.getValue();
+        } else if constexpr (std::is_same_v<Node, IttBinaryOperationNode>) {
+            walk(concrete.getLhs(), count, total);
+            walk(concrete.getRhs(), count, total);
+        } else if constexpr (std::is_same_v<Node, IttReturnNode>) {
+            if (concrete.getReturnStmt()) walk(**concrete.getReturnStmt(), count, total);
+        }
+    });
+}
+
+TEST(IttTest, VisitDispatchTest) {
+    IttReturnNode ret(sum(integer(1), sum(integer(2), arena.make<IttIdentifierNode>(Symbol::intern("x")))));
+
+    size_t count = 0;
+    int total = 0;
+    walk(ret, count, total);
+    ASSERT_EQ(count, 6u);
+    ASSERT_EQ(total, 3);
+
+    IttNode& node = ret;
+    IttKind kind = visitItt(node, [](auto& concrete) { return std::decay_t<decltype(concrete)>::kind; });
+    ASSERT_EQ(kind, IttKind::RETURN);
+}
+
+TEST(IttTest, StructuralEqualityTest) {
+    auto x = Symbol::intern("x");
+    auto y = Symbol::intern("y");
+
+    EXPECT_TRUE(*sum(integer(1), integer(2)) == *sum(integer(1), integer(2)));
+    EXPECT_FALSE(*sum(integer(1), integer(2)) == *sum(integer(2), integer(1)));
+    EXPECT_FALSE(*integer(1) == IttFloatNode(1.0f));
+    EXPECT_FALSE(IttIdentifierNode(x) == IttIdentifierNode(y));
+    EXPECT_FALSE(*sum(integer(1), integer(2)) ==
+                 IttBinaryOperationNode(integer(1), integer(2), IttBinaryOperation::SUB));
+
+    EXPECT_TRUE(IttVariableNode(x, integer(1)) == IttVariableNode(x, integer(1)));
+    EXPECT_FALSE(IttVariableNode(x, integer(1)) == IttVariableNode(y, integer(1)));
+
+    EXPECT_TRUE(IttReturnNode(nullptr) == IttReturnNode(nullptr));
+    EXPECT_FALSE(IttReturnNode(nullptr) == IttReturnNode(integer(0)));
+
+    auto first = arena.copy(std::vector<IttNode*>{integer(1), arena.make<IttReturnNode>(integer(2))});
+    auto second = arena.copy(std::vector<IttNode*>{integer(1), arena.make<IttReturnNode>(integer(2))});
+    auto shorter = arena.copy(std::vector<IttNode*>{integer(1)});
+    EXPECT_TRUE(IttBlockNode(first) == IttBlockNode(second));
+    EXPECT_FALSE(IttBlockNode(first) == IttBlockNode(shorter));
+
+    auto params = arena.copy(std::vector<std::pair<Symbol, IttType>>{{x, IttType(IttType::INT)}});
+    auto otherParams = arena.copy(std::vector<std::pair<Symbol, IttType>>{{x, IttType(IttType::FLOAT)}});
+    auto body = arena.make<IttBlockNode>(first);
+    IttType intType(IttType::INT);
+    EXPECT_TRUE(IttFunctionNode(x, params, intType, body) == IttFunctionNode(x, params, intType, arena.make<IttBlockNode>(second)));
+    EXPECT_FALSE(IttFunctionNode(x, params, intType, body) == IttFunctionNode(x, otherParams, intType, body));
+    EXPECT_FALSE(IttFunctionNode(x, params, intType, body) == IttFunctionNode(x, params, IttType(IttType::VOID), body));
+    EXPECT_FALSE(IttFunctionNode(x, params, intType, body) ==
+                 IttFunctionNode(x, params, intType, body, IttVisibility::PUBLIC));
+
+    auto args = arena.copy(std::vector<IttNode*>{integer(1), sum(integer(2), integer(3))});
+    auto sameArgs = arena.copy(std::vector<IttNode*>{integer(1), sum(integer(2), integer(3))});
+    EXPECT_TRUE(IttCallNode(x, args) == IttCallNode(x, sameArgs));
+    EXPECT_FALSE(IttCallNode(x, args) == IttCallNode(y, args));
+    EXPECT_FALSE(IttCallNode(x, args) == IttCallNode(x, shorter));
+}
+
+TEST(IttTest, DeepEqualityTest) {
+    IttNode* first = integer(0);
+    IttNode* second = integer(0);
+    for (int i = 1; i < 20000; ++i) {
+        first = sum(first, integer(i));
+        second = sum(second, integer(i));
+    }
+
+    EXPECT_TRUE(*first == *second);
+    EXPECT_FALSE(*first == *sum(second, integer(0)));
+}
+
+TEST(IttTest, StructuralHashTest) {
+    auto x = Symbol::intern("x");
+
+    EXPECT_EQ(sum(integer(1), integer(2))->structuralHash(), sum(integer(1), integer(2))->structuralHash());
+    EXPECT_NE(sum(integer(1), integer(2))->structuralHash(), sum(integer(2), integer(1))->structuralHash());
+    EXPECT_NE(integer(1)->structuralHash(), IttFloatNode(1.0f).structuralHash());
+    EXPECT_EQ(IttFloatNode(0.0f).structuralHash(), IttFloatNode(-0.0f).structuralHash());
+    EXPECT_NE(IttReturnNode(nullptr).structuralHash(), IttReturnNode(integer(0)).structuralHash());
+
+    IttIdentifierNode typed(x);
+    typed.setType(IttType(IttType::INT));
+    EXPECT_EQ(typed.structuralHash(), IttIdentifierNode(x).structuralHash());
+}
+
+TEST(IttTest, HashConsingTest) {
+    Arena shared;
+    HashConsingFactory factory(shared, 2);
+    auto x = Symbol::intern("x");
+
+    IttNode* one = factory.make<IttIntegerNode>(1);
+    EXPECT_EQ(factory.make<IttIntegerNode>(1), one);
+    EXPECT_NE(factory.make<IttIntegerNode>(2), one);
+    EXPECT_NE(static_cast<IttNode*>(factory.make<IttFloatNode>(1.0f)), one);
+
+    IttNode* xPlusOne = factory.make<IttBinaryOperationNode>(factory.make<IttIdentifierNode>(x), one, IttBinaryOperation::ADD);
+    EXPECT_EQ(factory.make<IttBinaryOperationNode>(factory.make<IttIdentifierNode>(x), one, IttBinaryOperation::ADD), xPlusOne);
+    EXPECT_NE(factory.make<IttBinaryOperationNode>(factory.make<IttIdentifierNode>(x), one, IttBinaryOperation::SUB), xPlusOne);
+    EXPECT_TRUE(*xPlusOne == *sum(arena.make<IttIdentifierNode>(x), integer(1)));
+
+    // 1, 2, 1.0f, x, x + 1 and x - 1, grown past the initial two slots.
+    EXPECT_EQ(factory.size(), 6u);
+    EXPECT_EQ(factory.hits(), 4u);
+
+    factory.clear();
+    EXPECT_EQ(factory.size(), 0u);
+    EXPECT_NE(factory.make<IttIntegerNode>(1), one);
+}
+
+TEST(IttTest, HashConsingSignedZeroTest) {
+    Arena shared;
+    HashConsingFactory factory(shared);
+
+    // Same hash bucket, since 0.0 == -0.0, but different literals: x / -0.0
+    // must not become x / 0.0.
+    IttFloatNode* zero = factory.make<IttFloatNode>(0.0f);
+    IttFloatNode* negativeZero = factory.make<IttFloatNode>(-0.0f);
+    EXPECT_NE(negativeZero, zero);
+    EXPECT_TRUE(std::signbit(negativeZero->getValue()));
+    EXPECT_EQ(factory.make<IttFloatNode>(-0.0f), negativeZero);
+
+    float nan = std::nanf("");
+    EXPECT_EQ(factory.make<IttFloatNode>(nan), factory.make<IttFloatNode>(nan));
+}
+
+TEST(IttTest, TypeContextTest) {
+    TypeContext types;
+    IttType intType(IttType::INT);
+    IttType charType(IttType::CHAR);
+
+    IttType buffer = types.arrayOf(charType, 4);
+    IttType callback = types.function(IttType(IttType::BOOL), {intType, types.pointerTo(buffer)});
+
+    EXPECT_EQ(types.arrayOf(IttType(IttType::CHAR), 4), buffer);
+    EXPECT_NE(types.arrayOf(charType, 5), buffer);
+    EXPECT_EQ(types.function(IttType(IttType::BOOL), {intType, types.pointerTo(types.arrayOf(charType, 4))}), callback);
+    EXPECT_NE(types.function(IttType(IttType::BOOL), {types.pointerTo(buffer), intType}), callback);
+
+    EXPECT_EQ(callback.getKind(), IttType::FUNCTION);
+    EXPECT_FALSE(callback.isPrimitive());
+    EXPECT_TRUE(intType.isPrimitive());
+    EXPECT_EQ(types.pointee(types.parameters(callback)[1]), buffer);
+    EXPECT_EQ(types.length(buffer), 4u);
+    EXPECT_EQ(types.toString(callback), "Fn(Int, *[Char; 4]) -> Bool");
+    EXPECT_THROW(types.pointee(buffer), std::invalid_argument);
+
+    IttType point = types.structType(Symbol::intern("Point"), {intType, intType});
+    EXPECT_EQ(types.structType(Symbol::intern("Point"), {intType, intType}), point);
+    EXPECT_NE(types.structType(Symbol::intern("Size"), {intType, intType}), point);
+    EXPECT_EQ(types.toString(types.pointerTo(point)), "*Point");
+
+    // Handles stay valid and unique while the table grows.
+    IttType nested = intType;
+    for (int i = 0; i < 1000; ++i) nested = types.pointerTo(nested);
+    size_t size = types.size();
+    IttType again = intType;
+    for (int i = 0; i < 1000; ++i) again = types.pointerTo(again);
+    EXPECT_EQ(again, nested);
+    EXPECT_EQ(types.size(), size);
+    EXPECT_LT(nested.getIndex(), types.size());
+}
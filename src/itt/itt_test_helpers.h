@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "ast_to_itt_translator/ast_to_itt_translator.h"
+#include "itt.h"
+#include "type_inference/type_inference.h"
+
+// Fixtures for the tests of the ITT passes, which start from source text.
+
+// Every function in source, translated, in order.
+inline std::vector<IttFunctionNode*> translated(const std::string& source, Arena& arena) {
+    Lexer lexer(source);
+    TokenStream tokens = lexer.tokenizeAll();
+
+    AstToIttTranslator translator(arena);
+    std::vector<IttFunctionNode*> functions;
+    for (FunctionNode* function : Parser(tokens, arena).parseProgram()) {
+        functions.push_back(static_cast<IttFunctionNode*>(translator.translate(*function)));
+    }
+    return functions;
+}
+
+// The first function in source, translated, with its types inferred on its
+// own.
+inline IttFunctionNode& inferred(const std::string& source, Arena& arena) {
+    IttFunctionNode& function = *translated(source, arena)[0];
+    TypeInference().run(function);
+    return function;
+}
+
+// Every function in source, translated, declared, and inferred in order.
+inline std::vector<IttFunctionNode*> inferredProgram(const std::string& source, Arena& arena) {
+    std::vector<IttFunctionNode*> functions = translated(source, arena);
+    TypeInference inference;
+    for (IttFunctionNode* function : functions) inference.declare(*function);
+    for (IttFunctionNode* function : functions) inference.run(*function);
+    return functions;
+}
+
+// The value of the last statement of function, which returns one.
+inline IttNode& returnedValue(IttFunctionNode& function) {
+    auto statements = static_cast<IttBlockNode&>(function.getBody()).getStatements();
+    return **ittCast<IttReturnNode>(*statements[statements.size() - 1])->getReturnStmt();
+}
@@ -1,6 +1,13 @@
 #pragma once
+#include <cstdint>
+#include <functional>
 #include <string>
 
+// A type as a 32-bit handle. The low bits hold the kind and the rest an
+// index that is dense within one TypeContext, so equality is an integer
+// compare and per-type tables can be plain vectors. Primitive types (and
+// UNRESOLVED) have the same handle in every context and need none to be
+// built; compound types come from TypeContext, which interns each one once.
 class IttType {
   public:
     enum TypeKind {
@@ -11,29 +18,62 @@ class IttType {
         FLOAT,
         IDENTIFIER,
         UNRESOLVED,
+        FUNCTION,
+        POINTER,
+        ARRAY,
+        STRUCT,
     };
 
+    static constexpr uint32_t kindBits = 4;
+    // Primitives take indexes 0..primitiveCount - 1, equal to their kind.
+    static constexpr uint32_t primitiveCount = UNRESOLVED + 1;
+
   private:
-    TypeKind _kind;
+    uint32_t _id;
+
+    IttType(uint32_t index, TypeKind kind) : _id(index << kindBits | kind) {}
+
+    friend class TypeContext;
 
   public:
-    explicit IttType(TypeKind kind) : _kind(kind) {}
+    // Only for primitive kinds and UNRESOLVED.
+    explicit IttType(TypeKind kind) : _id(static_cast<uint32_t>(kind) << kindBits | kind) {}
+
+    TypeKind getKind() const { return static_cast<TypeKind>(_id & ((1u << kindBits) - 1)); }
+    uint32_t getIndex() const { return _id >> kindBits; }
+    uint32_t getId() const { return _id; }
 
-    TypeKind getKind() const { return _kind; }
+    bool isPrimitive() const { return getIndex() < primitiveCount; }
 
+    // The kind's name; TypeContext::toString spells out compound types.
     std::string toString() const {
-        switch (_kind) {
+        switch (getKind()) {
         case INT: return "Int";
         case CHAR: return "Char";
         case BOOL: return "Bool";
         case VOID: return "Void";
         case FLOAT: return "Float";
         case UNRESOLVED: return "Unresolved";
+        case FUNCTION: return "Function";
+        case POINTER: return "Pointer";
+        case ARRAY: return "Array";
+        case STRUCT: return "Struct";
         default: return "Unknown";
         }
     }
 
     bool operator==(const IttType& other) const {
-      return _kind == other._kind;
+      return _id == other._id;
     }
-};
\ No newline at end of file
+
+    bool operator!=(const IttType& other) const {
+      return _id != other._id;
+    }
+};
+
+static_assert(IttType::STRUCT < (1u << IttType::kindBits), "kinds must fit in the handle's low bits");
+
+template <>
+struct std::hash<IttType> {
+    size_t operator()(IttType type) const { return type.getId(); }
+};
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <thread>
+
+#include "../dead_code/dead_code.h"
+#include "pass_manager.h"
+
+FunctionSummary summarize(const IttFunctionNode& function) {
+    FunctionSummary summary;
+    std::vector<const IttNode*> pending = {&function};
+
+    while (!pending.empty()) {
+        const IttNode* node = pending.back();
+        pending.pop_back();
+        summary.nodes++;
+
+        switch (node->getKind()) {
+            case IttKind::CALL: {
+                auto* call = static_cast<const IttCallNode*>(node);
+                summary.callees.push_back(call->getCallee());
+                for (IttNode* argument : call->getArguments()) pending.push_back(argument);
+                break;
+            }
+            case IttKind::BINARY_OPERATION: {
+                auto* binary = static_cast<const IttBinaryOperationNode*>(node);
+                pending.push_back(&binary->getLhs());
+                pending.push_back(&binary->getRhs());
+                break;
+            }
+            case IttKind::UNARY_OPERATION:
+                pending.push_back(&static_cast<const IttUnaryOperationNode*>(node)->getOperand());
+                break;
+            case IttKind::VARIABLE:
+                pending.push_back(&static_cast<const IttVariableNode*>(node)->getContent());
+                break;
+            case IttKind::RETURN:
+                if (auto value = static_cast<const IttReturnNode*>(node)->getReturnStmt()) pending.push_back(*value);
+                break;
+            case IttKind::BLOCK:
+                for (IttNode* statement : static_cast<const IttBlockNode*>(node)->getStatements()) {
+                    pending.push_back(statement);
+                }
+                break;
+            case IttKind::FUNCTION:
+                pending.push_back(&static_cast<const IttFunctionNode*>(node)->getBody());
+                break;
+            default:
+                break;
+        }
+    }
+    return summary;
+}
+
+void addCounter(PassCounters& counters, const std::string& name, size_t count) {
+    for (auto& counter : counters) {
+        if (counter.first == name) {
+            counter.second += count;
+            return;
+        }
+    }
+    counters.emplace_back(name, count);
+}
+
+const FunctionSummary& IttAnalyses::summary(const IttFunctionNode& function) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto cached = _summaries.find(&function);
+        if (cached != _summaries.end()) {
+            _reused++;
+            return cached->second;
+        }
+    }
+
+    // Walk without the lock; if another thread got there first, its entry wins.
+    FunctionSummary computed = summarize(function);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _computed++;
+    return _summaries.emplace(&function, std::move(computed)).first->second;
+}
+
+const std::vector<bool>& IttAnalyses::reachable(const std::vector<IttFunctionNode*>& program) {
+    if (_reachableValid && _reachable.size() == program.size()) {
+        _reused++;
+        return _reachable;
+    }
+
+    _reachable = reachableFunctions(program, [&](size_t caller) -> const std::vector<Symbol>& {
+        return summary(*program[caller]).callees;
+    });
+    _reachableValid = true;
+    _computed++;
+    return _reachable;
+}
+
+void IttAnalyses::invalidate(const IttFunctionNode& function) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _summaries.erase(&function);
+}
+
+void IttAnalyses::replace(const IttFunctionNode& from, const IttFunctionNode& to) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto cached = _summaries.find(&from);
+    if (cached == _summaries.end()) return;
+    _summaries.insert_or_assign(&to, std::move(cached->second));
+    _summaries.erase(&from);
+}
+
+void IttAnalyses::invalidateSummaries() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _summaries.clear();
+}
+
+void IttAnalyses::invalidateAll() {
+    invalidateSummaries();
+    invalidateReachability();
+}
+
+PassManager::PassManager(unsigned threads) : _threads(threads == 0 ? 1 : threads), _seconds(0) {
+    _arenas.resize(_threads);
+}
+
+void PassManager::addProgramPass(std::string name, ProgramPass pass, uint32_t preserved) {
+    _passes.push_back({std::move(name), nullptr, std::move(pass), preserved});
+}
+
+size_t PassManager::countNodes(const std::vector<IttFunctionNode*>& program) {
+    size_t nodes = 0;
+    for (const IttFunctionNode* function : program) nodes += _analyses.summary(*function).nodes;
+    return nodes;
+}
+
+void PassManager::runProgramPass(const Pass& pass, std::vector<IttFunctionNode*>& program) {
+    PassStatistics statistics{pass.name, false, 0, countNodes(program), 0, {}};
+
+    auto start = std::chrono::steady_clock::now();
+    pass.programPass(program, _analyses, statistics.counters);
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!(pass.preserved & PRESERVES_SUMMARIES)) _analyses.invalidateSummaries();
+    if (!(pass.preserved & PRESERVES_REACHABILITY)) _analyses.invalidateReachability();
+
+    statistics.nodesAfter = countNodes(program);
+    _statistics.push_back(std::move(statistics));
+}
+
+// Runs passes first..last - 1 on every function, each function on one worker
+// from start to end.
+void PassManager::runFunctionPasses(size_t first, size_t last, std::vector<IttFunctionNode*>& program) {
+    size_t passCount = last - first;
+    struct Totals {
+        std::vector<double> seconds;
+        std::vector<size_t> nodesBefore;
+        std::vector<size_t> nodesAfter;
+        std::vector<PassCounters> counters;
+        bool changed = false;
+    };
+    unsigned workerCount = static_cast<unsigned>(std::min<size_t>(_threads, program.size()));
+    std::vector<Totals> totals(std::max(workerCount, 1u));
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto work = [&](unsigned worker) {
+        Totals& mine = totals[worker];
+        mine.seconds.assign(passCount, 0);
+        mine.nodesBefore.assign(passCount, 0);
+        mine.nodesAfter.assign(passCount, 0);
+        mine.counters.assign(passCount, {});
+
+        try {
+            std::vector<std::unique_ptr<FunctionPass>> passes;
+            for (size_t i = first; i < last; ++i) passes.push_back(_passes[i].makeFunctionPass(_arenas[worker]));
+
+            for (size_t index = next++; index < program.size() && !failed; index = next++) {
+                IttFunctionNode* function = program[index];
+                for (size_t i = 0; i < passCount; ++i) {
+                    mine.nodesBefore[i] += _analyses.summary(*function).nodes;
+
+                    auto start = std::chrono::steady_clock::now();
+                    IttFunctionNode* result = passes[i]->run(*function);
+                    mine.seconds[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    if (result != function) {
+                        if (_passes[first + i].preserved & PRESERVES_SUMMARIES) {
+                            _analyses.replace(*function, *result);
+                        } else {
+                            _analyses.invalidate(*function);
+                        }
+                        if (!(_passes[first + i].preserved & PRESERVES_REACHABILITY)) mine.changed = true;
+                        function = result;
+                    }
+                    mine.nodesAfter[i] += _analyses.summary(*function).nodes;
+                }
+                program[index] = function;
+            }
+            for (size_t i = 0; i < passCount; ++i) passes[i]->addCounters(mine.counters[i]);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned worker = 1; worker < workerCount; ++worker) workers.emplace_back(work, worker);
+    work(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        _analyses.invalidateReachability();
+        std::rethrow_exception(error);
+    }
+
+    for (size_t i = 0; i < passCount; ++i) {
+        PassStatistics statistics{_passes[first + i].name, true, 0, 0, 0, {}};
+        for (const Totals& worker : totals) {
+            statistics.seconds += worker.seconds[i];
+            statistics.nodesBefore += worker.nodesBefore[i];
+            statistics.nodesAfter += worker.nodesAfter[i];
+            for (const auto& counter : worker.counters[i]) addCounter(statistics.counters, counter.first, counter.second);
+        }
+        _statistics.push_back(std::move(statistics));
+    }
+    for (const Totals& worker : totals) {
+        if (worker.changed) _analyses.invalidateReachability();
+    }
+}
+
+void PassManager::run(std::vector<IttFunctionNode*>& program) {
+    _statistics.clear();
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < _passes.size();) {
+        if (_passes[i].programPass) {
+            runProgramPass(_passes[i], program);
+            i++;
+            continue;
+        }
+
+        size_t last = i;
+        while (last < _passes.size() && !_passes[last].programPass) last++;
+        runFunctionPasses(i, last, program);
+        i = last;
+    }
+
+    _seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PassManager::printStatistics(std::ostream& out) const {
+    out << std::left << std::setw(24) << "pass" << std::right << std::setw(12) << "ms" << std::setw(12) << "nodes in"
+        << std::setw(12) << "nodes out" << "\n";
+    for (const PassStatistics& pass : _statistics) {
+        out << std::left << std::setw(24) << (pass.perFunction ? pass.name : pass.name + " (program)") << std::right
+            << std::setw(12) << std::fixed << std::setprecision(3) << pass.seconds * 1000 << std::setw(12)
+            << pass.nodesBefore << std::setw(12) << pass.nodesAfter << "\n";
+        for (const auto& counter : pass.counters) {
+            out << "  " << counter.first << ": " << counter.second << "\n";
+        }
+    }
+    out << std::left << std::setw(24) << "total (wall)" << std::right << std::setw(12) << _seconds * 1000 << "\n";
+    out << "analyses: " << _analyses.computed() << " computed, " << _analyses.reused() << " reused\n";
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../itt.h"
+
+// What one walk over a function learns: its node count and the name of
+// every function it calls, once per call.
+struct FunctionSummary {
+    size_t nodes = 0;
+    std::vector<Symbol> callees;
+};
+
+FunctionSummary summarize(const IttFunctionNode& function);
+
+// Analyses of a program, computed on first request and kept until
+// invalidated. Nodes are immutable, so a summary stays right for as long as
+// its function node is the one in the program; a pass that replaces a
+// function makes the pass manager drop or move its entry. Reachability
+// depends on the whole program and is dropped when any function changes
+// unless the pass says it preserves it.
+//
+// summary() may be called from several threads at once.
+class IttAnalyses {
+    std::mutex _mutex;
+    // Node-based, so a returned reference survives later insertions.
+    std::unordered_map<const IttFunctionNode*, FunctionSummary> _summaries;
+    std::vector<bool> _reachable;
+    bool _reachableValid;
+
+    size_t _computed;
+    size_t _reused;
+
+public:
+    IttAnalyses() : _reachableValid(false), _computed(0), _reused(0) {}
+
+    const FunctionSummary& summary(const IttFunctionNode& function);
+    // Which of program the roots reach, as reachableFunctions in dead_code.h.
+    const std::vector<bool>& reachable(const std::vector<IttFunctionNode*>& program);
+
+    void invalidate(const IttFunctionNode& function);
+    // Moves the summary of from, if any, to to, when a pass rebuilt a
+    // function without changing what the summary records.
+    void replace(const IttFunctionNode& from, const IttFunctionNode& to);
+    void invalidateSummaries();
+    void invalidateReachability() { _reachableValid = false; }
+    void invalidateAll();
+
+    // Analyses run and analyses answered from the cache, over all requests.
+    size_t computed() const { return _computed; }
+    size_t reused() const { return _reused; }
+};
+
+// Analyses a pass leaves correct, as a mask.
+enum PreservedAnalyses : uint32_t {
+    PRESERVES_NOTHING = 0,
+    PRESERVES_SUMMARIES = 1 << 0,
+    PRESERVES_REACHABILITY = 1 << 1,
+    PRESERVES_ALL = PRESERVES_SUMMARIES | PRESERVES_REACHABILITY,
+};
+
+// What a pass counted, by name, in the order the pass first reported each.
+using PassCounters = std::vector<std::pair<std::string, size_t>>;
+
+// Adds count to the counter called name, which starts at zero.
+void addCounter(PassCounters& counters, const std::string& name, size_t count);
+
+// A pass over one function. run() returns the new function, or function
+// itself if nothing changed, and must not look at other functions.
+// addCounters() adds what the pass counted over all its runs.
+class FunctionPass {
+public:
+    virtual ~FunctionPass() = default;
+    virtual IttFunctionNode* run(IttFunctionNode& function) = 0;
+    virtual void addCounters(PassCounters& counters) const = 0;
+};
+
+// Wraps any class with an Arena& constructor and such a run(), like
+// ConstantFolder and DeadCodeEliminator. If the class also has a counters()
+// that lists (name, count) pairs, those are its counters.
+template <typename T>
+class FunctionPassModel : public FunctionPass {
+    T _pass;
+
+    template <typename U>
+    static auto addCountersOf(const U& pass, PassCounters& counters, int) -> decltype(pass.counters(), void()) {
+        for (const auto& counter : pass.counters()) addCounter(counters, counter.first, counter.second);
+    }
+    template <typename U>
+    static void addCountersOf(const U&, PassCounters&, long) {}
+
+public:
+    explicit FunctionPassModel(Arena& arena) : _pass(arena) {}
+    IttFunctionNode* run(IttFunctionNode& function) override { return _pass.run(function); }
+    void addCounters(PassCounters& counters) const override { addCountersOf(_pass, counters, 0); }
+};
+
+// Time, node counts and counters of one pass over the whole program. A
+// function pass's time and counters are summed over the functions,
+// whichever worker ran them.
+struct PassStatistics {
+    std::string name;
+    bool perFunction;
+    double seconds;
+    size_t nodesBefore;
+    size_t nodesAfter;
+    PassCounters counters;
+};
+
+// Runs a declared pipeline of passes over a program.
+//
+// Function passes see one function at a time and are independent across
+// functions, so a run of consecutive function passes is applied function by
+// function, on up to threads workers: each claims the next function, runs
+// the whole run of passes on it with its own pass instances and its own
+// arena, and moves on. Program passes see every function and the analyses,
+// and run alone on the calling thread between those runs.
+//
+// Nodes the workers make live in the manager's arenas, so the manager must
+// outlive the program it returns. An exception from any pass stops the
+// pipeline and is rethrown from run().
+class PassManager {
+public:
+    // Gets the program, the analyses, and the counters to add to.
+    using ProgramPass = std::function<void(std::vector<IttFunctionNode*>&, IttAnalyses&, PassCounters&)>;
+
+private:
+    using FunctionPassFactory = std::function<std::unique_ptr<FunctionPass>(Arena&)>;
+
+    struct Pass {
+        std::string name;
+        FunctionPassFactory makeFunctionPass;
+        ProgramPass programPass;
+        uint32_t preserved;
+    };
+
+    unsigned _threads;
+    std::vector<Pass> _passes;
+    std::vector<Arena> _arenas;
+    IttAnalyses _analyses;
+
+    std::vector<PassStatistics> _statistics;
+    double _seconds;
+
+    size_t countNodes(const std::vector<IttFunctionNode*>& program);
+    void runProgramPass(const Pass& pass, std::vector<IttFunctionNode*>& program);
+    void runFunctionPasses(size_t first, size_t last, std::vector<IttFunctionNode*>& program);
+
+public:
+    explicit PassManager(unsigned threads = 1);
+
+    template <typename T>
+    void addFunctionPass(std::string name, uint32_t preserved = PRESERVES_NOTHING) {
+        _passes.push_back({std::move(name),
+                           [](Arena& arena) -> std::unique_ptr<FunctionPass> {
+                               return std::make_unique<FunctionPassModel<T>>(arena);
+                           },
+                           nullptr, preserved});
+    }
+    void addProgramPass(std::string name, ProgramPass pass, uint32_t preserved = PRESERVES_NOTHING);
+
+    void run(std::vector<IttFunctionNode*>& program);
+
+    IttAnalyses& analyses() { return _analyses; }
+
+    // One entry per declared pass, from the last run().
+    const std::vector<PassStatistics>& statistics() const { return _statistics; }
+    double seconds() const { return _seconds; }
+    void printStatistics(std::ostream& out) const;
+};
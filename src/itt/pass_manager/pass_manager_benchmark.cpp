@@ -0,0 +1,88 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../constant_folding/constant_folding.h"
+#include "../dead_code/dead_code.h"
+#include "pass_manager.h"
+
+// Functions of locals that each read an earlier one through a little
+// constant arithmetic, so both folding and dead code find work. Every fourth
+// function is public; the others call into the next function or are never
+// called.
+static IttFunctionNode* generateFunction(Arena& arena, int index, int functions, int statements) {
+    Symbol parameter = Symbol::intern("input");
+    auto local = [](int i) { return Symbol::intern("local_" + std::to_string(i)); };
+
+    std::vector<IttNode*> body;
+    for (int i = 0; i < statements; ++i) {
+        IttNode* read = i < 4 ? static_cast<IttNode*>(arena.make<IttIdentifierNode>(parameter))
+                              : arena.make<IttIdentifierNode>(local(i - 1 - (i * 7 + index) % 4));
+        IttNode* scale = arena.make<IttBinaryOperationNode>(arena.make<IttIntegerNode>(i % 3 + 1),
+                                                            arena.make<IttIntegerNode>(2), IttBinaryOperation::MUL);
+        IttNode* value = arena.make<IttBinaryOperationNode>(
+            arena.make<IttBinaryOperationNode>(read, scale, IttBinaryOperation::MUL), arena.make<IttIntegerNode>(0),
+            IttBinaryOperation::ADD);
+        if (i == statements * 3 / 4) {
+            if (index % 2 == 0 && index + 1 < functions) {
+                auto args = arena.copy(std::vector<IttNode*>{value});
+                value = arena.make<IttCallNode>(Symbol::intern("generated_" + std::to_string(index + 1)), args);
+            }
+            body.push_back(arena.make<IttReturnNode>(value));
+        } else {
+            body.push_back(arena.make<IttVariableNode>(local(i), value));
+        }
+    }
+
+    std::vector<std::pair<Symbol, IttType>> params = {{parameter, IttType(IttType::INT)}};
+    IttVisibility visibility = index % 4 == 0 ? IttVisibility::PUBLIC : IttVisibility::PRIVATE;
+    return arena.make<IttFunctionNode>(Symbol::intern("generated_" + std::to_string(index)), arena.copy(params),
+                                       IttType(IttType::INT), arena.make<IttBlockNode>(arena.copy(body)), visibility);
+}
+
+static void pruneFunctions(std::vector<IttFunctionNode*>& program, IttAnalyses& analyses, PassCounters& counters) {
+    addCounter(counters, "pruned functions", DeadCodeEliminator::prune(program, analyses.reachable(program)));
+}
+
+// Best time of the pipeline on threads workers; leaves the last run's
+// statistics in out.
+static double measure(const std::vector<IttFunctionNode*>& program, unsigned threads, int iterations,
+                      std::ostream* out) {
+    double best = 1e100;
+    for (int i = 0; i < iterations; ++i) {
+        PassManager passes(threads);
+        passes.addFunctionPass<ConstantFolder>("constant folding");
+        passes.addFunctionPass<DeadCodeEliminator>("dead code");
+        passes.addProgramPass("prune", pruneFunctions, PRESERVES_SUMMARIES);
+
+        std::vector<IttFunctionNode*> result = program;
+        auto start = std::chrono::steady_clock::now();
+        passes.run(result);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+
+        if (out && i + 1 == iterations) passes.printStatistics(*out);
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int functionCount = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int statements = argc > 2 ? std::stoi(argv[2]) : 200;
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 5;
+    unsigned threads = argc > 4 ? std::stoul(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+
+    Arena arena;
+    std::vector<IttFunctionNode*> program;
+    for (int i = 0; i < functionCount; ++i) program.push_back(generateFunction(arena, i, functionCount, statements));
+
+    double one = measure(program, 1, iterations, nullptr);
+    double many = measure(program, threads, iterations, &std::cout);
+
+    std::cout << "pipeline:       " << one * 1000 << " ms on 1 thread, " << many * 1000 << " ms on " << threads
+              << " (" << one / many << "x)\n";
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+#include "../constant_folding/constant_folding.h"
+#include "../dead_code/dead_code.h"
+#include "../itt_test_helpers.h"
+#include "pass_manager.h"
+
+static const char* const source =
+    "pub fn api(x Int) -> Int { y = x * 1 + 0; z = 4 * 2; ret helper(y) + z; }\n"
+    "fn helper(x Int) -> Int { unused = x + 1; ret x * 8; y = 2; }\n"
+    "fn orphan() -> Int { ret helper(1); }\n"
+    "fn main() -> Int { a = 2 + 3; ret a; }\n";
+
+static void inferTypes(std::vector<IttFunctionNode*>& program, IttAnalyses&, PassCounters&) {
+    TypeInference typeInference;
+    for (IttFunctionNode* function : program) typeInference.declare(*function);
+    for (IttFunctionNode* function : program) typeInference.run(*function);
+}
+
+static void pruneFunctions(std::vector<IttFunctionNode*>& program, IttAnalyses& analyses, PassCounters& counters) {
+    addCounter(counters, "pruned functions", DeadCodeEliminator::prune(program, analyses.reachable(program)));
+}
+
+static void declarePipeline(PassManager& passes) {
+    passes.addProgramPass("type inference", inferTypes, PRESERVES_ALL);
+    passes.addFunctionPass<ConstantFolder>("constant folding");
+    passes.addFunctionPass<DeadCodeEliminator>("dead code");
+    passes.addProgramPass("prune", pruneFunctions, PRESERVES_SUMMARIES);
+}
+
+// The same passes called by hand, one function after another.
+static std::vector<IttFunctionNode*> sequential(Arena& arena) {
+    auto program = translated(source, arena);
+    IttAnalyses analyses;
+    PassCounters counters;
+    inferTypes(program, analyses, counters);
+
+    ConstantFolder folder(arena);
+    DeadCodeEliminator eliminator(arena);
+    for (IttFunctionNode*& function : program) function = eliminator.run(*folder.run(*function));
+    eliminator.prune(program);
+    return program;
+}
+
+static void expectSamePrograms(const std::vector<IttFunctionNode*>& actual,
+                               const std::vector<IttFunctionNode*>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_TRUE(*actual[i] == *expected[i]) << actual[i]->getName().str();
+    }
+}
+
+TEST(PassManagerTest, MatchesSequentialPassesTest) {
+    Arena arena;
+    auto expected = sequential(arena);
+
+    PassManager passes;
+    declarePipeline(passes);
+    auto program = translated(source, arena);
+    passes.run(program);
+
+    ASSERT_EQ(program.size(), 3u);
+    EXPECT_EQ(program[0]->getName(), "api");
+    EXPECT_EQ(program[1]->getName(), "helper");
+    EXPECT_EQ(program[2]->getName(), "main");
+    expectSamePrograms(program, expected);
+}
+
+TEST(PassManagerTest, ParallelMatchesOneThreadTest) {
+    std::string text;
+    for (int i = 0; i < 64; ++i) {
+        std::string n = std::to_string(i);
+        text += "pub fn f" + n + "(x Int) -> Int { a = x * 2 + " + n + "; b = a; ret a * 1 + g" + n + "(x); }\n";
+        text += "fn g" + n + "(x Int) -> Int { ret x + 3 * 4; c = 1; }\n";
+    }
+
+    Arena arena;
+    PassManager one(1);
+    declarePipeline(one);
+    auto expected = translated(text, arena);
+    one.run(expected);
+
+    PassManager four(4);
+    declarePipeline(four);
+    auto program = translated(text, arena);
+    four.run(program);
+
+    expectSamePrograms(program, expected);
+    for (size_t i = 0; i < one.statistics().size(); ++i) {
+        EXPECT_EQ(four.statistics()[i].nodesBefore, one.statistics()[i].nodesBefore);
+        EXPECT_EQ(four.statistics()[i].nodesAfter, one.statistics()[i].nodesAfter);
+        EXPECT_EQ(four.statistics()[i].counters, one.statistics()[i].counters);
+    }
+}
+
+TEST(PassManagerTest, CachesAnalysesUntilInvalidatedTest) {
+    Arena arena;
+    auto program = translated(source, arena);
+    IttAnalyses analyses;
+
+    const FunctionSummary& helper = analyses.summary(*program[1]);
+    EXPECT_EQ(helper.nodes, 12u);
+    EXPECT_TRUE(helper.callees.empty());
+    ASSERT_EQ(program[0]->getName(), "api");
+    EXPECT_EQ(analyses.summary(*program[0]).callees, std::vector<Symbol>{Symbol::intern("helper")});
+    EXPECT_EQ(&analyses.summary(*program[1]), &helper);
+    EXPECT_EQ(analyses.computed(), 2u);
+    EXPECT_EQ(analyses.reused(), 1u);
+
+    EXPECT_EQ(analyses.reachable(program), (std::vector<bool>{true, true, false, true}));
+    analyses.reachable(program);
+    // main's summary is new, api's and helper's are reused; orphan is never
+    // reached, so never walked.
+    EXPECT_EQ(analyses.computed(), 4u);
+    EXPECT_EQ(analyses.reused(), 4u);
+
+    analyses.invalidate(*program[1]);
+    analyses.invalidateReachability();
+    analyses.reachable(program);
+    EXPECT_EQ(analyses.computed(), 6u);
+}
+
+TEST(PassManagerTest, KeepsSummariesOfUnchangedFunctionsTest) {
+    Arena arena;
+    auto program = translated("fn main() -> Int { ret 1; }\nfn other(x Int) -> Int { ret x + 0; }\n", arena);
+    IttFunctionNode* unchanged = program[0];
+
+    PassManager passes;
+    passes.addFunctionPass<ConstantFolder>("constant folding");
+    passes.run(program);
+
+    // Only the folded function was walked again for the node count after.
+    EXPECT_EQ(program[0], unchanged);
+    EXPECT_EQ(passes.analyses().computed(), 3u);
+    EXPECT_EQ(passes.analyses().reused(), 1u);
+}
+
+TEST(PassManagerTest, ReportsStatisticsTest) {
+    Arena arena;
+    auto program = translated(source, arena);
+    PassManager passes(2);
+    declarePipeline(passes);
+    passes.run(program);
+
+    const auto& statistics = passes.statistics();
+    ASSERT_EQ(statistics.size(), 4u);
+    EXPECT_EQ(statistics[0].name, "type inference");
+    EXPECT_FALSE(statistics[0].perFunction);
+    EXPECT_TRUE(statistics[1].perFunction);
+    EXPECT_EQ(statistics[0].nodesBefore, statistics[0].nodesAfter);
+    EXPECT_LT(statistics[1].nodesAfter, statistics[1].nodesBefore);
+    EXPECT_LT(statistics[2].nodesAfter, statistics[2].nodesBefore);
+    EXPECT_LT(statistics[3].nodesAfter, statistics[3].nodesBefore);
+    for (size_t i = 1; i < statistics.size(); ++i) {
+        EXPECT_EQ(statistics[i].nodesBefore, statistics[i - 1].nodesAfter);
+    }
+
+    // Counted by each worker's pass instances and summed.
+    EXPECT_TRUE(statistics[0].counters.empty());
+    EXPECT_EQ(statistics[1].counters,
+              (PassCounters{{"folded", 2}, {"simplified", 2}, {"strength reduced", 1}}));
+    EXPECT_EQ(statistics[2].counters, (PassCounters{{"unreachable statements", 1}, {"unused variables", 1}}));
+    EXPECT_EQ(statistics[3].counters, (PassCounters{{"pruned functions", 1}}));
+
+    std::ostringstream out;
+    passes.printStatistics(out);
+    EXPECT_NE(out.str().find("dead code"), std::string::npos);
+    EXPECT_NE(out.str().find("prune (program)"), std::string::npos);
+    EXPECT_NE(out.str().find("  pruned functions: 1\n"), std::string::npos);
+}
+
+class FailingPass {
+public:
+    explicit FailingPass(Arena&) {}
+    IttFunctionNode* run(IttFunctionNode& function) {
+        if (function.getName() == "orphan") throw std::runtime_error("cannot handle orphan");
+        return &function;
+    }
+};
+
+TEST(PassManagerTest, RethrowsPassErrorsTest) {
+    Arena arena;
+    auto program = translated(source, arena);
+    PassManager passes(3);
+    passes.addFunctionPass<FailingPass>("failing");
+    EXPECT_THROW(passes.run(program), std::runtime_error);
+}
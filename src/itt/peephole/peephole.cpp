@@ -0,0 +1,374 @@
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "peephole.h"
+
+OperandClass classifyOperand(const IttNode& node) {
+    switch (node.getKind()) {
+        case IttKind::INTEGER: {
+            uint32_t value = static_cast<uint32_t>(static_cast<const IttIntegerNode&>(node).getValue());
+            if (value == 0) return OperandClass::INT_ZERO;
+            if (value == 1) return OperandClass::INT_ONE;
+            // INT_MIN counts as 2^31: multiplying by it wraps exactly like
+            // shifting by 31.
+            if ((value & (value - 1)) == 0) return OperandClass::INT_POWER_OF_TWO;
+            return OperandClass::INT;
+        }
+        case IttKind::FLOAT: {
+            float value = static_cast<const IttFloatNode&>(node).getValue();
+            if (value == 0.0f && !std::signbit(value)) return OperandClass::FLOAT_ZERO;
+            if (value == 1.0f) return OperandClass::FLOAT_ONE;
+            return OperandClass::FLOAT;
+        }
+        case IttKind::BOOLEAN:
+            return static_cast<const IttBooleanNode&>(node).getValue() ? OperandClass::BOOL_TRUE : OperandClass::BOOL_FALSE;
+        case IttKind::CHAR:
+            return OperandClass::CHAR;
+        default:
+            return OperandClass::OTHER;
+    }
+}
+
+// Whether expression calls a function. A call may have side effects, so a
+// rule must not drop one.
+static bool hasCall(const IttNode& expression) {
+    std::vector<const IttNode*> pending = {&expression};
+    while (!pending.empty()) {
+        const IttNode* node = pending.back();
+        pending.pop_back();
+        switch (node->getKind()) {
+            case IttKind::CALL:
+                return true;
+            case IttKind::BINARY_OPERATION: {
+                auto* binary = static_cast<const IttBinaryOperationNode*>(node);
+                pending.push_back(&binary->getLhs());
+                pending.push_back(&binary->getRhs());
+                break;
+            }
+            case IttKind::UNARY_OPERATION:
+                pending.push_back(&static_cast<const IttUnaryOperationNode*>(node)->getOperand());
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+IttNode* PeepholeRewriter::integer(int value) {
+    IttNode* node = _arena.make<IttIntegerNode>(value);
+    node->setType(IttType(IttType::INT));
+    return node;
+}
+
+IttNode* PeepholeRewriter::floating(float value) {
+    IttNode* node = _arena.make<IttFloatNode>(value);
+    node->setType(IttType(IttType::FLOAT));
+    return node;
+}
+
+IttNode* PeepholeRewriter::boolean(bool value) {
+    IttNode* node = _arena.make<IttBooleanNode>(value);
+    node->setType(IttType(IttType::BOOL));
+    return node;
+}
+
+// The operation's value on two literals, or null if it has none at compile
+// time.
+IttNode* PeepholeRewriter::evaluate(IttBinaryOperation op, IttNode& lhs, IttNode& rhs) {
+    auto* leftInt = ittCast<IttIntegerNode>(lhs);
+    auto* rightInt = ittCast<IttIntegerNode>(rhs);
+    if (leftInt && rightInt) {
+        int x = leftInt->getValue();
+        int y = rightInt->getValue();
+        // Wrapping arithmetic is done unsigned, where overflow is defined.
+        uint32_t a = static_cast<uint32_t>(x);
+        uint32_t b = static_cast<uint32_t>(y);
+        switch (op) {
+            case IttBinaryOperation::ADD: return integer(static_cast<int>(a + b));
+            case IttBinaryOperation::SUB: return integer(static_cast<int>(a - b));
+            case IttBinaryOperation::MUL: return integer(static_cast<int>(a * b));
+            case IttBinaryOperation::DIV:
+                if (y == 0 || (x == INT_MIN && y == -1)) return nullptr;
+                return integer(x / y);
+            case IttBinaryOperation::SHL:
+                if (y < 0 || y > 31) return nullptr;
+                return integer(static_cast<int>(a << y));
+            case IttBinaryOperation::LESS_THEN: return boolean(x < y);
+            case IttBinaryOperation::GREATER_THEN: return boolean(x > y);
+            case IttBinaryOperation::LESS_EQUALS: return boolean(x <= y);
+            case IttBinaryOperation::GREATER_EQUALS: return boolean(x >= y);
+            case IttBinaryOperation::EQUALS: return boolean(x == y);
+            case IttBinaryOperation::NOT_EQUALS: return boolean(x != y);
+            default: return nullptr;
+        }
+    }
+
+    auto* leftFloat = ittCast<IttFloatNode>(lhs);
+    auto* rightFloat = ittCast<IttFloatNode>(rhs);
+    if (leftFloat && rightFloat) {
+        float x = leftFloat->getValue();
+        float y = rightFloat->getValue();
+        switch (op) {
+            case IttBinaryOperation::ADD: return floating(x + y);
+            case IttBinaryOperation::SUB: return floating(x - y);
+            case IttBinaryOperation::MUL: return floating(x * y);
+            case IttBinaryOperation::DIV: return floating(x / y);
+            case IttBinaryOperation::LESS_THEN: return boolean(x < y);
+            case IttBinaryOperation::GREATER_THEN: return boolean(x > y);
+            case IttBinaryOperation::LESS_EQUALS: return boolean(x <= y);
+            case IttBinaryOperation::GREATER_EQUALS: return boolean(x >= y);
+            case IttBinaryOperation::EQUALS: return boolean(x == y);
+            case IttBinaryOperation::NOT_EQUALS: return boolean(x != y);
+            default: return nullptr;
+        }
+    }
+
+    auto* leftBool = ittCast<IttBooleanNode>(lhs);
+    auto* rightBool = ittCast<IttBooleanNode>(rhs);
+    if (leftBool && rightBool) {
+        bool x = leftBool->getValue();
+        bool y = rightBool->getValue();
+        switch (op) {
+            case IttBinaryOperation::AND: return boolean(x && y);
+            case IttBinaryOperation::OR: return boolean(x || y);
+            case IttBinaryOperation::EQUALS: return boolean(x == y);
+            case IttBinaryOperation::NOT_EQUALS: return boolean(x != y);
+            default: return nullptr;
+        }
+    }
+
+    auto* leftChar = ittCast<IttCharNode>(lhs);
+    auto* rightChar = ittCast<IttCharNode>(rhs);
+    if (leftChar && rightChar) {
+        char x = leftChar->getValue();
+        char y = rightChar->getValue();
+        switch (op) {
+            case IttBinaryOperation::LESS_THEN: return boolean(x < y);
+            case IttBinaryOperation::GREATER_THEN: return boolean(x > y);
+            case IttBinaryOperation::LESS_EQUALS: return boolean(x <= y);
+            case IttBinaryOperation::GREATER_EQUALS: return boolean(x >= y);
+            case IttBinaryOperation::EQUALS: return boolean(x == y);
+            case IttBinaryOperation::NOT_EQUALS: return boolean(x != y);
+            default: return nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+bool PeepholeRewriter::guard(PeepholeGuard guard, IttBinaryOperationNode& node, IttNode& lhs, IttNode& rhs) {
+    switch (guard) {
+        case PeepholeGuard::NONE:
+            return true;
+        case PeepholeGuard::SAME_OPERANDS:
+            return lhs == rhs;
+        case PeepholeGuard::SAME_INT_OPERANDS:
+            return lhs.getType().getKind() == IttType::INT && lhs == rhs;
+        case PeepholeGuard::NESTED_INT_CONSTANT: {
+            auto* inner = ittCast<IttBinaryOperationNode>(lhs);
+            return inner && inner->getOperation() == node.getOperation() && ittCast<IttIntegerNode>(inner->getRhs());
+        }
+    }
+    return false;
+}
+
+// The rewritten operation, or null if the rewrite does not apply after all.
+IttNode* PeepholeRewriter::apply(PeepholeRewrite rewrite, IttBinaryOperationNode& node, IttNode& lhs, IttNode& rhs) {
+    switch (rewrite) {
+        case PeepholeRewrite::EVALUATE:
+            return evaluate(node.getOperation(), lhs, rhs);
+        case PeepholeRewrite::LHS:
+            return hasCall(rhs) ? nullptr : &lhs;
+        case PeepholeRewrite::RHS:
+            return hasCall(lhs) ? nullptr : &rhs;
+        case PeepholeRewrite::INT_ZERO:
+            return hasCall(lhs) || hasCall(rhs) ? nullptr : integer(0);
+        case PeepholeRewrite::TRUE:
+            return hasCall(lhs) || hasCall(rhs) ? nullptr : boolean(true);
+        case PeepholeRewrite::FALSE:
+            return hasCall(lhs) || hasCall(rhs) ? nullptr : boolean(false);
+        case PeepholeRewrite::SHIFT_LHS:
+        case PeepholeRewrite::SHIFT_RHS: {
+            bool literalOnRight = rewrite == PeepholeRewrite::SHIFT_LHS;
+            auto& literal = static_cast<IttIntegerNode&>(literalOnRight ? rhs : lhs);
+            int shift = __builtin_ctz(static_cast<uint32_t>(literal.getValue()));
+            return make<IttBinaryOperationNode>(node, literalOnRight ? &lhs : &rhs, integer(shift), IttBinaryOperation::SHL);
+        }
+        case PeepholeRewrite::REASSOCIATE: {
+            auto& inner = static_cast<IttBinaryOperationNode&>(lhs);
+            uint32_t a = static_cast<uint32_t>(static_cast<IttIntegerNode&>(inner.getRhs()).getValue());
+            uint32_t b = static_cast<uint32_t>(static_cast<IttIntegerNode&>(rhs).getValue());
+            uint32_t value;
+            switch (node.getOperation()) {
+                case IttBinaryOperation::ADD: value = a + b; break;
+                case IttBinaryOperation::MUL: value = a * b; break;
+                default:
+                    if (a > 31 || b > 31 || a + b > 31) return nullptr;
+                    value = a + b;
+            }
+            return make<IttBinaryOperationNode>(node, &inner.getLhs(), integer(static_cast<int>(value)), node.getOperation());
+        }
+    }
+    return nullptr;
+}
+
+// The operation over already rewritten operands, after every rule that
+// matches it, or what it rewrites to, has been applied.
+IttNode* PeepholeRewriter::rewriteOperation(IttBinaryOperationNode& original, IttNode* lhs, IttNode* rhs) {
+    IttBinaryOperationNode* node = &original;
+    while (true) {
+        uint64_t candidates = peepholeTable[peepholeCell(node->getOperation(), classifyOperand(*lhs), classifyOperand(*rhs))];
+
+        IttNode* result = nullptr;
+        for (; candidates && !result; candidates &= candidates - 1) {
+            size_t rule = __builtin_ctzll(candidates);
+            if (!guard(peepholeRules[rule].guard, *node, *lhs, *rhs)) continue;
+            result = apply(peepholeRules[rule].rewrite, *node, *lhs, *rhs);
+            if (result) _hits[rule]++;
+        }
+
+        if (!result) {
+            bool changed = lhs != &node->getLhs() || rhs != &node->getRhs();
+            return changed ? make<IttBinaryOperationNode>(*node, lhs, rhs, node->getOperation()) : node;
+        }
+
+        // Operands are rewritten already; only an operation a rule built
+        // can match again.
+        auto* built = ittCast<IttBinaryOperationNode>(*result);
+        if (!built || result == lhs || result == rhs) return result;
+        node = built;
+        lhs = &built->getLhs();
+        rhs = &built->getRhs();
+    }
+}
+
+IttNode* PeepholeRewriter::rewriteExpression(IttNode& root) {
+    _work.emplace_back(&root, false);
+
+    while (!_work.empty()) {
+        auto [node, operandsDone] = _work.back();
+        _work.pop_back();
+
+        switch (node->getKind()) {
+            case IttKind::BINARY_OPERATION: {
+                auto* binary = static_cast<IttBinaryOperationNode*>(node);
+                if (!operandsDone) {
+                    _work.emplace_back(node, true);
+                    _work.emplace_back(&binary->getRhs(), false);
+                    _work.emplace_back(&binary->getLhs(), false);
+                    break;
+                }
+
+                IttNode* rhs = _values.back();
+                _values.pop_back();
+                IttNode* lhs = _values.back();
+                _values.pop_back();
+                _values.push_back(rewriteOperation(*binary, lhs, rhs));
+                break;
+            }
+            case IttKind::UNARY_OPERATION: {
+                auto* unary = static_cast<IttUnaryOperationNode*>(node);
+                if (!operandsDone) {
+                    _work.emplace_back(node, true);
+                    _work.emplace_back(&unary->getOperand(), false);
+                    break;
+                }
+
+                IttNode* operand = _values.back();
+                if (operand != &unary->getOperand()) {
+                    _values.back() = make<IttUnaryOperationNode>(*unary, operand, unary->getOperation());
+                } else {
+                    _values.back() = unary;
+                }
+                break;
+            }
+            case IttKind::CALL: {
+                auto* call = static_cast<IttCallNode*>(node);
+                Span<IttNode*> arguments = call->getArguments();
+                if (!operandsDone) {
+                    _work.emplace_back(node, true);
+                    for (size_t i = arguments.size(); i-- > 0;) {
+                        _work.emplace_back(arguments[i], false);
+                    }
+                    break;
+                }
+
+                size_t first = _values.size() - arguments.size();
+                bool changed = false;
+                for (size_t i = 0; i < arguments.size(); ++i) {
+                    changed |= _values[first + i] != arguments[i];
+                }
+                IttNode* result = call;
+                if (changed) {
+                    result = make<IttCallNode>(*call, call->getCallee(), _arena.copy(_values.data() + first, arguments.size()));
+                }
+                _values.resize(first);
+                _values.push_back(result);
+                break;
+            }
+            default:
+                _values.push_back(node);
+        }
+    }
+
+    IttNode* result = _values.back();
+    _values.pop_back();
+    return result;
+}
+
+IttNode* PeepholeRewriter::rewriteStatement(IttNode& statement) {
+    switch (statement.getKind()) {
+        case IttKind::VARIABLE: {
+            auto& variable = static_cast<IttVariableNode&>(statement);
+            IttNode* content = rewriteExpression(variable.getContent());
+            if (content == &variable.getContent()) return &statement;
+            return make<IttVariableNode>(statement, variable.getName(), content);
+        }
+        case IttKind::RETURN: {
+            auto value = static_cast<IttReturnNode&>(statement).getReturnStmt();
+            if (!value) return &statement;
+            IttNode* rewritten = rewriteExpression(**value);
+            if (rewritten == *value) return &statement;
+            return make<IttReturnNode>(statement, rewritten);
+        }
+        case IttKind::BLOCK: {
+            auto statements = static_cast<IttBlockNode&>(statement).getStatements();
+            size_t first = _statements.size();
+            bool changed = false;
+            for (IttNode* inner : statements) {
+                IttNode* rewritten = rewriteStatement(*inner);
+                changed |= rewritten != inner;
+                _statements.push_back(rewritten);
+            }
+
+            IttNode* result = &statement;
+            if (changed) {
+                result = make<IttBlockNode>(statement, _arena.copy(_statements.data() + first, _statements.size() - first));
+            }
+            _statements.resize(first);
+            return result;
+        }
+        default:
+            return rewriteExpression(statement);
+    }
+}
+
+IttFunctionNode* PeepholeRewriter::run(IttFunctionNode& function) {
+    IttNode* body = rewriteStatement(function.getBody());
+    if (body == &function.getBody()) return &function;
+
+    return static_cast<IttFunctionNode*>(make<IttFunctionNode>(
+        function, function.getName(), function.getParameters(), function.getReturnType(), body,
+        function.getVisibility()));
+}
+
+size_t PeepholeRewriter::hits(PeepholeCategory category) const {
+    size_t total = 0;
+    for (size_t rule = 0; rule < peepholeRuleCount; ++rule) {
+        if (peepholeRules[rule].category == category) total += _hits[rule];
+    }
+    return total;
+}
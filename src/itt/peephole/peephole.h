@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "../itt.h"
+#include "peephole_rules.h"
+
+// Applies the rules in peephole_rules.h to every binary operation of a
+// function, bottom-up: operands are rewritten before the operation that
+// uses them, and a node made by a rule is matched again until no rule
+// applies, so one traversal leaves no match anywhere in the tree.
+//
+// Matching is table-driven: each operand is classified once, and the
+// decision table gives the candidate rules for the operation and the two
+// classes; only those have their guards checked. Adding a rule is adding a
+// line to peepholeRules. Call arguments are rewritten like any operand; calls
+// themselves are opaque to the rules, and since an extern callee may have
+// side effects, a rewrite that would drop an operand holding a call, as
+// f(x) * 0 or f(x) && f(x) would, is not applied.
+//
+// Nodes are never changed in place, since their structural hash covers
+// their children: changed expressions and their ancestors are rebuilt in
+// the arena, carrying over resolved types, and untouched subtrees are
+// shared with the input.
+class PeepholeRewriter {
+    Arena& _arena;
+
+    std::vector<std::pair<IttNode*, bool>> _work;
+    std::vector<IttNode*> _values;
+    std::vector<IttNode*> _statements;
+
+    std::array<size_t, peepholeRuleCount> _hits;
+
+    template <typename T, typename... Args>
+    IttNode* make(const IttNode& replacing, Args&&... args) {
+        T* node = _arena.make<T>(std::forward<Args>(args)...);
+        node->setType(replacing.getType());
+        return node;
+    }
+
+    IttNode* integer(int value);
+    IttNode* floating(float value);
+    IttNode* boolean(bool value);
+    IttNode* evaluate(IttBinaryOperation op, IttNode& lhs, IttNode& rhs);
+    bool guard(PeepholeGuard guard, IttBinaryOperationNode& node, IttNode& lhs, IttNode& rhs);
+    IttNode* apply(PeepholeRewrite rewrite, IttBinaryOperationNode& node, IttNode& lhs, IttNode& rhs);
+    IttNode* rewriteOperation(IttBinaryOperationNode& node, IttNode* lhs, IttNode* rhs);
+    IttNode* rewriteExpression(IttNode& root);
+    IttNode* rewriteStatement(IttNode& statement);
+
+public:
+    explicit PeepholeRewriter(Arena& arena) : _arena(arena), _hits{} {}
+
+    // The rewritten function; function itself if no rule applied.
+    IttFunctionNode* run(IttFunctionNode& function);
+
+    // Times peepholeRules[rule], or any rule of a category, applied over
+    // all runs.
+    size_t hits(size_t rule) const { return _hits[rule]; }
+    size_t hits(PeepholeCategory category) const;
+};
+
+// The class rules see of an operand.
+OperandClass classifyOperand(const IttNode& node);
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "peephole.h"
+
+// Typed Int arithmetic where three in seven leaves are a parameter, so most
+// operations survive folding and go through the identity, reassociation and
+// shift rules rather than just evaluation.
+static IttNode* generateExpression(Arena& arena, int depth, int seed, Symbol parameter) {
+    IttNode* node;
+    if (depth == 0) {
+        static const int literals[] = {0, 1, 2, 3, 8};
+        if (seed % 7 < 3) node = arena.make<IttIdentifierNode>(parameter);
+        else node = arena.make<IttIntegerNode>(literals[seed % 5]);
+    } else {
+        static const IttBinaryOperation ops[] = {IttBinaryOperation::ADD, IttBinaryOperation::MUL, IttBinaryOperation::SUB};
+        node = arena.make<IttBinaryOperationNode>(generateExpression(arena, depth - 1, seed * 3 + 1, parameter),
+                                                  generateExpression(arena, depth - 1, seed * 3 + 2, parameter),
+                                                  ops[seed % 3]);
+    }
+    node->setType(IttType(IttType::INT));
+    return node;
+}
+
+static IttFunctionNode* generateFunction(Arena& arena, int statements, int depth) {
+    Symbol parameter = Symbol::intern("input");
+    std::vector<IttNode*> body;
+    for (int i = 0; i < statements; ++i) {
+        body.push_back(arena.make<IttReturnNode>(generateExpression(arena, depth, i, parameter)));
+    }
+    std::vector<std::pair<Symbol, IttType>> params = {{parameter, IttType(IttType::INT)}};
+    return arena.make<IttFunctionNode>(Symbol::intern("generated"), arena.copy(params), IttType(IttType::INT),
+                                       arena.make<IttBlockNode>(arena.copy(body)));
+}
+
+static size_t countOperations(const IttNode& node) {
+    if (auto* binary = ittCast<IttBinaryOperationNode>(node)) {
+        return 1 + countOperations(binary->getLhs()) + countOperations(binary->getRhs());
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int statements = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int depth = argc > 2 ? std::stoi(argv[2]) : 8;
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    Arena arena;
+    IttFunctionNode* function = generateFunction(arena, statements, depth);
+    size_t operations = 0;
+    for (IttNode* statement : static_cast<IttBlockNode&>(function->getBody()).getStatements()) {
+        operations += countOperations(**static_cast<IttReturnNode&>(*statement).getReturnStmt());
+    }
+
+    double best = 1e100;
+    std::vector<size_t> hits(peepholeRuleCount);
+    for (int i = 0; i < iterations; ++i) {
+        Arena output;
+        PeepholeRewriter rewriter(output);
+        auto start = std::chrono::steady_clock::now();
+        rewriter.run(*function);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+
+        for (size_t rule = 0; rule < peepholeRuleCount; ++rule) hits[rule] = rewriter.hits(rule);
+    }
+
+    std::cout << "rewrite:        " << best * 1000 << " ms (" << best / operations * 1e9 << " ns/operation, "
+              << operations << " operations)\n";
+    for (size_t rule = 0; rule < peepholeRuleCount; ++rule) {
+        if (hits[rule]) std::cout << "  " << peepholeRules[rule].name << ": " << hits[rule] << "\n";
+    }
+
+    return 0;
+}
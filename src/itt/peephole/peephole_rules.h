@@ -0,0 +1,178 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../itt.h"
+
+// What a peephole rule can see of an operand without walking it: literals
+// are split by the values rules care about, everything else is OTHER.
+enum class OperandClass : uint8_t {
+    OTHER,
+    INT_ZERO,
+    INT_ONE,
+    // Above 1; INT_MIN counts as 2^31.
+    INT_POWER_OF_TWO,
+    INT,
+    // +0.0 only; -0.0 is FLOAT.
+    FLOAT_ZERO,
+    FLOAT_ONE,
+    FLOAT,
+    BOOL_TRUE,
+    BOOL_FALSE,
+    CHAR,
+    COUNT
+};
+
+constexpr size_t operandClassCount = static_cast<size_t>(OperandClass::COUNT);
+constexpr size_t binaryOperationCount = static_cast<size_t>(IttBinaryOperation::SHL) + 1;
+
+// Sets of operand classes and of operations, as bitmasks.
+using OperandMatch = uint16_t;
+using OperationMatch = uint16_t;
+
+constexpr OperandMatch operands(OperandClass c) { return OperandMatch(1u << static_cast<unsigned>(c)); }
+template <typename... Classes>
+constexpr OperandMatch operands(OperandClass c, Classes... rest) { return operands(c) | operands(rest...); }
+
+constexpr OperandMatch anyOperand = OperandMatch((1u << operandClassCount) - 1);
+constexpr OperandMatch anyInt = operands(OperandClass::INT_ZERO, OperandClass::INT_ONE, OperandClass::INT_POWER_OF_TWO, OperandClass::INT);
+constexpr OperandMatch anyLiteral = OperandMatch(anyOperand & ~operands(OperandClass::OTHER));
+
+constexpr OperationMatch operations(IttBinaryOperation op) { return OperationMatch(1u << static_cast<unsigned>(op)); }
+template <typename... Ops>
+constexpr OperationMatch operations(IttBinaryOperation op, Ops... rest) { return operations(op) | operations(rest...); }
+
+constexpr OperationMatch anyOperation = OperationMatch((1u << binaryOperationCount) - 1);
+
+// Checks beyond the operand classes, run only on candidates.
+enum class PeepholeGuard : uint8_t {
+    NONE,
+    // The operands are equal trees.
+    SAME_OPERANDS,
+    // The operands are equal trees of type Int, where x - x and x == x
+    // hold even though they do not for NaN.
+    SAME_INT_OPERANDS,
+    // The left operand is the same operation with an Int literal on its
+    // right, as in (x + 1) + 2.
+    NESTED_INT_CONSTANT,
+};
+
+enum class PeepholeRewrite : uint8_t {
+    // Compute the value of two literals; does not apply if there is none,
+    // e.g. for 1 / 0.
+    EVALUATE,
+    LHS,
+    RHS,
+    INT_ZERO,
+    TRUE,
+    FALSE,
+    // x * 2^k and 2^k * x to x << k.
+    SHIFT_LHS,
+    SHIFT_RHS,
+    // (x op a) op b to x op (a op b), for wrapping Int + and *, and to
+    // x << (a + b) for shifts that stay below 32.
+    REASSOCIATE,
+};
+
+enum class PeepholeCategory : uint8_t {
+    FOLD,
+    IDENTITY,
+    STRENGTH_REDUCTION,
+    REASSOCIATION,
+};
+
+struct PeepholeRule {
+    const char* name;
+    OperationMatch ops;
+    OperandMatch lhs;
+    OperandMatch rhs;
+    PeepholeGuard guard;
+    PeepholeRewrite rewrite;
+    PeepholeCategory category;
+};
+
+// In priority order: where several rules match, the first one that applies
+// wins. Float rules leave out x + 0.0 and x * 0.0, which are wrong for -0.0,
+// NaN and infinity.
+constexpr PeepholeRule peepholeRules[] = {
+    {"fold constants", anyOperation, anyLiteral, anyLiteral, PeepholeGuard::NONE, PeepholeRewrite::EVALUATE, PeepholeCategory::FOLD},
+
+    {"x + 0", operations(IttBinaryOperation::ADD), anyOperand, operands(OperandClass::INT_ZERO), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"0 + x", operations(IttBinaryOperation::ADD), operands(OperandClass::INT_ZERO), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::RHS, PeepholeCategory::IDENTITY},
+    {"x - 0", operations(IttBinaryOperation::SUB), anyOperand, operands(OperandClass::INT_ZERO, OperandClass::FLOAT_ZERO), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"x - x", operations(IttBinaryOperation::SUB), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::INT_ZERO, PeepholeCategory::IDENTITY},
+    {"x * 1", operations(IttBinaryOperation::MUL), anyOperand, operands(OperandClass::INT_ONE, OperandClass::FLOAT_ONE), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"1 * x", operations(IttBinaryOperation::MUL), operands(OperandClass::INT_ONE, OperandClass::FLOAT_ONE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::RHS, PeepholeCategory::IDENTITY},
+    {"x * 0", operations(IttBinaryOperation::MUL), anyOperand, operands(OperandClass::INT_ZERO), PeepholeGuard::NONE, PeepholeRewrite::INT_ZERO, PeepholeCategory::IDENTITY},
+    {"0 * x", operations(IttBinaryOperation::MUL), operands(OperandClass::INT_ZERO), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::INT_ZERO, PeepholeCategory::IDENTITY},
+    {"x / 1", operations(IttBinaryOperation::DIV), anyOperand, operands(OperandClass::INT_ONE, OperandClass::FLOAT_ONE), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"x << 0", operations(IttBinaryOperation::SHL), anyOperand, operands(OperandClass::INT_ZERO), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+
+    {"x && true", operations(IttBinaryOperation::AND), anyOperand, operands(OperandClass::BOOL_TRUE), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"true && x", operations(IttBinaryOperation::AND), operands(OperandClass::BOOL_TRUE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::RHS, PeepholeCategory::IDENTITY},
+    {"x && false", operations(IttBinaryOperation::AND), anyOperand, operands(OperandClass::BOOL_FALSE), PeepholeGuard::NONE, PeepholeRewrite::FALSE, PeepholeCategory::IDENTITY},
+    {"false && x", operations(IttBinaryOperation::AND), operands(OperandClass::BOOL_FALSE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::FALSE, PeepholeCategory::IDENTITY},
+    {"x || false", operations(IttBinaryOperation::OR), anyOperand, operands(OperandClass::BOOL_FALSE), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"false || x", operations(IttBinaryOperation::OR), operands(OperandClass::BOOL_FALSE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::RHS, PeepholeCategory::IDENTITY},
+    {"x || true", operations(IttBinaryOperation::OR), anyOperand, operands(OperandClass::BOOL_TRUE), PeepholeGuard::NONE, PeepholeRewrite::TRUE, PeepholeCategory::IDENTITY},
+    {"true || x", operations(IttBinaryOperation::OR), operands(OperandClass::BOOL_TRUE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::TRUE, PeepholeCategory::IDENTITY},
+    {"x && x", operations(IttBinaryOperation::AND), anyOperand, anyOperand, PeepholeGuard::SAME_OPERANDS, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"x || x", operations(IttBinaryOperation::OR), anyOperand, anyOperand, PeepholeGuard::SAME_OPERANDS, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"x == true", operations(IttBinaryOperation::EQUALS), anyOperand, operands(OperandClass::BOOL_TRUE), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"true == x", operations(IttBinaryOperation::EQUALS), operands(OperandClass::BOOL_TRUE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::RHS, PeepholeCategory::IDENTITY},
+    {"x != false", operations(IttBinaryOperation::NOT_EQUALS), anyOperand, operands(OperandClass::BOOL_FALSE), PeepholeGuard::NONE, PeepholeRewrite::LHS, PeepholeCategory::IDENTITY},
+    {"false != x", operations(IttBinaryOperation::NOT_EQUALS), operands(OperandClass::BOOL_FALSE), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::RHS, PeepholeCategory::IDENTITY},
+    {"x == x", operations(IttBinaryOperation::EQUALS), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::TRUE, PeepholeCategory::IDENTITY},
+    {"x <= x", operations(IttBinaryOperation::LESS_EQUALS), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::TRUE, PeepholeCategory::IDENTITY},
+    {"x >= x", operations(IttBinaryOperation::GREATER_EQUALS), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::TRUE, PeepholeCategory::IDENTITY},
+    {"x != x", operations(IttBinaryOperation::NOT_EQUALS), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::FALSE, PeepholeCategory::IDENTITY},
+    {"x < x", operations(IttBinaryOperation::LESS_THEN), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::FALSE, PeepholeCategory::IDENTITY},
+    {"x > x", operations(IttBinaryOperation::GREATER_THEN), anyOperand, anyOperand, PeepholeGuard::SAME_INT_OPERANDS, PeepholeRewrite::FALSE, PeepholeCategory::IDENTITY},
+
+    {"(x + a) + b", operations(IttBinaryOperation::ADD), operands(OperandClass::OTHER), anyInt, PeepholeGuard::NESTED_INT_CONSTANT, PeepholeRewrite::REASSOCIATE, PeepholeCategory::REASSOCIATION},
+    {"(x * a) * b", operations(IttBinaryOperation::MUL), operands(OperandClass::OTHER), anyInt, PeepholeGuard::NESTED_INT_CONSTANT, PeepholeRewrite::REASSOCIATE, PeepholeCategory::REASSOCIATION},
+    {"(x << a) << b", operations(IttBinaryOperation::SHL), operands(OperandClass::OTHER), anyInt, PeepholeGuard::NESTED_INT_CONSTANT, PeepholeRewrite::REASSOCIATE, PeepholeCategory::REASSOCIATION},
+
+    {"x * 2^k", operations(IttBinaryOperation::MUL), anyOperand, operands(OperandClass::INT_POWER_OF_TWO), PeepholeGuard::NONE, PeepholeRewrite::SHIFT_LHS, PeepholeCategory::STRENGTH_REDUCTION},
+    {"2^k * x", operations(IttBinaryOperation::MUL), operands(OperandClass::INT_POWER_OF_TWO), anyOperand, PeepholeGuard::NONE, PeepholeRewrite::SHIFT_RHS, PeepholeCategory::STRENGTH_REDUCTION},
+};
+
+constexpr size_t peepholeRuleCount = sizeof(peepholeRules) / sizeof(peepholeRules[0]);
+static_assert(peepholeRuleCount <= 64, "candidate sets are 64-bit masks");
+
+// The decision table: for each operation and pair of operand classes, the
+// rules that can match, as a bitmask in priority order. Built by the
+// compiler, so matching a node is two classifications and one load.
+using PeepholeTable = std::array<uint64_t, binaryOperationCount * operandClassCount * operandClassCount>;
+
+constexpr size_t peepholeCell(IttBinaryOperation op, OperandClass lhs, OperandClass rhs) {
+    return (static_cast<size_t>(op) * operandClassCount + static_cast<size_t>(lhs)) * operandClassCount +
+           static_cast<size_t>(rhs);
+}
+
+constexpr PeepholeTable buildPeepholeTable() {
+    PeepholeTable table{};
+    for (size_t op = 0; op < binaryOperationCount; ++op) {
+        for (size_t lhs = 0; lhs < operandClassCount; ++lhs) {
+            for (size_t rhs = 0; rhs < operandClassCount; ++rhs) {
+                uint64_t candidates = 0;
+                for (size_t rule = 0; rule < peepholeRuleCount; ++rule) {
+                    const PeepholeRule& r = peepholeRules[rule];
+                    if ((r.ops >> op & 1) && (r.lhs >> lhs & 1) && (r.rhs >> rhs & 1)) {
+                        candidates |= uint64_t(1) << rule;
+                    }
+                }
+                table[(op * operandClassCount + lhs) * operandClassCount + rhs] = candidates;
+            }
+        }
+    }
+    return table;
+}
+
+constexpr PeepholeTable peepholeTable = buildPeepholeTable();
+
+static_assert(peepholeTable[peepholeCell(IttBinaryOperation::ADD, OperandClass::OTHER, OperandClass::INT_ZERO)] & 0b10,
+              "x + 0 is a candidate for x + 0");
+static_assert(peepholeTable[peepholeCell(IttBinaryOperation::ADD, OperandClass::OTHER, OperandClass::OTHER)] == 0,
+              "x + y needs no rule lookups");
@@ -0,0 +1,121 @@
+#include <cstring>
+#include <gtest/gtest.h>
+
+#include "../itt_test_helpers.h"
+#include "peephole.h"
+
+static size_t ruleNamed(const char* name) {
+    for (size_t rule = 0; rule < peepholeRuleCount; ++rule) {
+        if (std::strcmp(peepholeRules[rule].name, name) == 0) return rule;
+    }
+    ADD_FAILURE() << "no rule " << name;
+    return 0;
+}
+
+// The value of the last return statement of the first function in source,
+// translated, typed and rewritten.
+static IttNode& rewritten(const std::string& source, Arena& arena, PeepholeRewriter& rewriter) {
+    return returnedValue(*rewriter.run(inferred(source, arena)));
+}
+
+static IttNode& rewritten(const std::string& source) {
+    static Arena arena;
+    PeepholeRewriter rewriter(arena);
+    return rewritten(source, arena, rewriter);
+}
+
+TEST(PeepholeTest, DecisionTableTest) {
+    uint64_t plain = peepholeTable[peepholeCell(IttBinaryOperation::MUL, OperandClass::OTHER, OperandClass::OTHER)];
+    EXPECT_EQ(plain, uint64_t(0));
+
+    uint64_t byEight = peepholeTable[peepholeCell(IttBinaryOperation::MUL, OperandClass::OTHER, OperandClass::INT_POWER_OF_TWO)];
+    EXPECT_TRUE(byEight >> ruleNamed("x * 2^k") & 1);
+    EXPECT_TRUE(byEight >> ruleNamed("(x * a) * b") & 1);
+    EXPECT_FALSE(byEight >> ruleNamed("x * 1") & 1);
+    EXPECT_FALSE(byEight >> ruleNamed("fold constants") & 1);
+
+    uint64_t literals = peepholeTable[peepholeCell(IttBinaryOperation::ADD, OperandClass::INT, OperandClass::INT_ZERO)];
+    EXPECT_EQ(__builtin_ctzll(literals), ruleNamed("fold constants"));
+}
+
+TEST(PeepholeTest, ClassifiesOperandsTest) {
+    EXPECT_EQ(classifyOperand(IttIntegerNode(0)), OperandClass::INT_ZERO);
+    EXPECT_EQ(classifyOperand(IttIntegerNode(1)), OperandClass::INT_ONE);
+    EXPECT_EQ(classifyOperand(IttIntegerNode(64)), OperandClass::INT_POWER_OF_TWO);
+    EXPECT_EQ(classifyOperand(IttIntegerNode(INT32_MIN)), OperandClass::INT_POWER_OF_TWO);
+    EXPECT_EQ(classifyOperand(IttIntegerNode(-4)), OperandClass::INT);
+    EXPECT_EQ(classifyOperand(IttFloatNode(0.0f)), OperandClass::FLOAT_ZERO);
+    EXPECT_EQ(classifyOperand(IttFloatNode(-0.0f)), OperandClass::FLOAT);
+    EXPECT_EQ(classifyOperand(IttFloatNode(1.0f)), OperandClass::FLOAT_ONE);
+    EXPECT_EQ(classifyOperand(IttBooleanNode(false)), OperandClass::BOOL_FALSE);
+    EXPECT_EQ(classifyOperand(IttCharNode('a')), OperandClass::CHAR);
+    EXPECT_EQ(classifyOperand(IttIdentifierNode(Symbol::intern("x"))), OperandClass::OTHER);
+}
+
+TEST(PeepholeTest, ReachesFixedPointInOnePassTest) {
+    IttIdentifierNode x(Symbol::intern("x"));
+
+    // Reassociation leaves x + 0, which the same visit removes.
+    EXPECT_TRUE(rewritten("fn f(x Int) -> Int { ret (x + 1) + (0 - 1); }") == x);
+    EXPECT_TRUE(rewritten("fn f(x Int) -> Bool { ret x - x == 0; }") == IttBooleanNode(true));
+
+    auto* sum = ittCast<IttBinaryOperationNode>(rewritten("fn f(x Int) -> Int { ret ((x + 1) + 2) + 3; }"));
+    ASSERT_NE(sum, nullptr);
+    EXPECT_TRUE(sum->getLhs() == x);
+    EXPECT_TRUE(sum->getRhs() == IttIntegerNode(6));
+
+    // (x * 3) * 4 reassociates before 4 could become a shift.
+    auto* product = ittCast<IttBinaryOperationNode>(rewritten("fn f(x Int) -> Int { ret x * 3 * 4; }"));
+    ASSERT_NE(product, nullptr);
+    EXPECT_EQ(product->getOperation(), IttBinaryOperation::MUL);
+    EXPECT_TRUE(product->getRhs() == IttIntegerNode(12));
+
+    auto* shift = ittCast<IttBinaryOperationNode>(rewritten("fn f(x Int) -> Int { ret x * 2 * 4; }"));
+    ASSERT_NE(shift, nullptr);
+    EXPECT_EQ(shift->getOperation(), IttBinaryOperation::SHL);
+    EXPECT_TRUE(shift->getRhs() == IttIntegerNode(3));
+    EXPECT_EQ(shift->getType().getKind(), IttType::INT);
+
+    auto* call = ittCast<IttCallNode>(rewritten("fn f(x Int) -> Int { ret f(x * 1 + 0); }"));
+    ASSERT_NE(call, nullptr);
+    EXPECT_TRUE(*call->getArguments()[0] == x);
+}
+
+TEST(PeepholeTest, SameOperandRulesTest) {
+    IttIdentifierNode x(Symbol::intern("x"));
+
+    EXPECT_TRUE(rewritten("fn f(x Bool) -> Bool { ret x || x; }") == x);
+    EXPECT_TRUE(rewritten("fn f(x Int) -> Bool { ret x + 1 < x + 1; }") == IttBooleanNode(false));
+    EXPECT_TRUE(rewritten("fn f(x Int) -> Bool { ret x >= x; }") == IttBooleanNode(true));
+
+    // NaN is not equal to itself.
+    EXPECT_EQ(rewritten("fn f(x Float) -> Bool { ret x == x; }").getKind(), IttKind::BINARY_OPERATION);
+    EXPECT_EQ(rewritten("fn f(x Float) -> Float { ret x - x; }").getKind(), IttKind::BINARY_OPERATION);
+}
+
+TEST(PeepholeTest, KeepsCallsTest) {
+    // Dropping an operand must not drop a call with it.
+    EXPECT_EQ(rewritten("fn f(x Int) -> Int { ret f(x) * 0; }").getKind(), IttKind::BINARY_OPERATION);
+    EXPECT_EQ(rewritten("fn f(x Int) -> Int { ret f(x) - f(x); }").getKind(), IttKind::BINARY_OPERATION);
+    EXPECT_EQ(rewritten("fn f(x Bool) -> Bool { ret f(x) && false; }").getKind(), IttKind::BINARY_OPERATION);
+
+    // Rules that keep every operand still apply.
+    EXPECT_EQ(rewritten("fn f(x Int) -> Int { ret f(x) * 1; }").getKind(), IttKind::CALL);
+}
+
+TEST(PeepholeTest, CountsHitsPerRuleTest) {
+    Arena arena;
+    PeepholeRewriter rewriter(arena);
+    rewritten("fn f(x Int) -> Int { y = x * 1 + 0; ret (x - x) + 2 * 3 + y * 16; }", arena, rewriter);
+
+    EXPECT_EQ(rewriter.hits(ruleNamed("x * 1")), 1u);
+    EXPECT_EQ(rewriter.hits(ruleNamed("x + 0")), 1u);
+    EXPECT_EQ(rewriter.hits(ruleNamed("x - x")), 1u);
+    EXPECT_EQ(rewriter.hits(ruleNamed("x * 2^k")), 1u);
+    // 2 * 3, then 0 + 6 once x - x is 0.
+    EXPECT_EQ(rewriter.hits(ruleNamed("fold constants")), 2u);
+    EXPECT_EQ(rewriter.hits(ruleNamed("0 + x")), 0u);
+    EXPECT_EQ(rewriter.hits(PeepholeCategory::IDENTITY), 3u);
+    EXPECT_EQ(rewriter.hits(PeepholeCategory::STRENGTH_REDUCTION), 1u);
+    EXPECT_EQ(rewriter.hits(PeepholeCategory::REASSOCIATION), 0u);
+}
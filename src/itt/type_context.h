@@ -0,0 +1,158 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../utilities/arena/arena.h"
+#include "../utilities/interner/string_interner.h"
+#include "itt_type.h"
+
+// Interns the types of one compilation: each distinct compound type is
+// stored once and named by its IttType handle, so comparing types, even
+// deeply nested ones, is comparing two integers. Structural lookups go
+// through a hash table keyed by a type's immediate parts, which are handles
+// themselves, so interning costs O(parts) and never walks a type tree.
+class TypeContext {
+    struct Entry {
+        IttType::TypeKind kind;
+        // Pointee, element or return type.
+        IttType inner;
+        // Array length or struct name.
+        uint32_t extra;
+        // Function parameters or struct fields.
+        Span<IttType> members;
+        uint32_t hash;
+    };
+
+    std::vector<Entry> _types;
+    // Open addressing over _types; 0 marks an empty slot, else index + 1.
+    std::vector<uint32_t> _slots;
+    Arena _members;
+
+    static uint32_t mix(uint32_t seed, uint32_t value) {
+        uint64_t h = (uint64_t(seed) << 32 | value) * 0x9E3779B97F4A7C15ull;
+        return static_cast<uint32_t>(h >> 32) ^ static_cast<uint32_t>(h);
+    }
+
+    static uint32_t hashOf(IttType::TypeKind kind, IttType inner, uint32_t extra, const IttType* members, size_t count) {
+        uint32_t hash = mix(mix(kind, inner.getId()), extra);
+        for (size_t i = 0; i < count; ++i) hash = mix(hash, members[i].getId());
+        return hash;
+    }
+
+    static bool sameMembers(Span<IttType> stored, const IttType* members, size_t count) {
+        if (stored.size() != count) return false;
+        for (size_t i = 0; i < count; ++i) {
+            if (stored[i] != members[i]) return false;
+        }
+        return true;
+    }
+
+    void insert(uint32_t index) {
+        size_t mask = _slots.size() - 1;
+        size_t slot = _types[index].hash & mask;
+        while (_slots[slot]) slot = (slot + 1) & mask;
+        _slots[slot] = index + 1;
+    }
+
+    IttType intern(IttType::TypeKind kind, IttType inner, uint32_t extra, const IttType* members, size_t count) {
+        uint32_t hash = hashOf(kind, inner, extra, members, count);
+
+        size_t mask = _slots.size() - 1;
+        for (size_t slot = hash & mask; _slots[slot]; slot = (slot + 1) & mask) {
+            const Entry& entry = _types[_slots[slot] - 1];
+            if (entry.hash == hash && entry.kind == kind && entry.inner == inner && entry.extra == extra &&
+                sameMembers(entry.members, members, count)) {
+                return IttType(_slots[slot] - 1, kind);
+            }
+        }
+
+        uint32_t index = static_cast<uint32_t>(_types.size());
+        if (index >= (1u << (32 - IttType::kindBits))) {
+            throw std::runtime_error("Too many distinct types");
+        }
+        _types.push_back(Entry{kind, inner, extra, _members.copy(members, count), hash});
+
+        if (_types.size() * 4 > _slots.size() * 3) {
+            _slots.assign(_slots.size() * 2, 0);
+            for (uint32_t i = IttType::primitiveCount; i < _types.size(); ++i) insert(i);
+        } else {
+            insert(index);
+        }
+        return IttType(index, kind);
+    }
+
+    const Entry& entry(IttType type, IttType::TypeKind kind) const {
+        if (type.getKind() != kind || type.getIndex() >= _types.size()) {
+            throw std::invalid_argument("Type " + type.toString() + " is not a " + IttType(0, kind).toString());
+        }
+        return _types[type.getIndex()];
+    }
+
+public:
+    TypeContext() : _slots(64, 0) {
+        // Primitives are never looked up, but own their indexes so that
+        // every handle indexes _types.
+        for (uint32_t kind = 0; kind < IttType::primitiveCount; ++kind) {
+            auto primitive = static_cast<IttType::TypeKind>(kind);
+            _types.push_back(Entry{primitive, IttType(primitive), 0, {}, 0});
+        }
+    }
+
+    TypeContext(const TypeContext&) = delete;
+    TypeContext& operator=(const TypeContext&) = delete;
+
+    IttType pointerTo(IttType pointee) {
+        return intern(IttType::POINTER, pointee, 0, nullptr, 0);
+    }
+
+    IttType arrayOf(IttType element, uint32_t length) {
+        return intern(IttType::ARRAY, element, length, nullptr, 0);
+    }
+
+    IttType function(IttType returnType, const std::vector<IttType>& parameters) {
+        return intern(IttType::FUNCTION, returnType, 0, parameters.data(), parameters.size());
+    }
+
+    // A struct type is its name together with its field types: the same name
+    // with other fields is another type, and so is another name with the
+    // same fields.
+    IttType structType(Symbol name, const std::vector<IttType>& fields) {
+        return intern(IttType::STRUCT, IttType(IttType::VOID), name.getId(), fields.data(), fields.size());
+    }
+
+    IttType pointee(IttType pointer) const { return entry(pointer, IttType::POINTER).inner; }
+    IttType element(IttType array) const { return entry(array, IttType::ARRAY).inner; }
+    uint32_t length(IttType array) const { return entry(array, IttType::ARRAY).extra; }
+    IttType returnType(IttType function) const { return entry(function, IttType::FUNCTION).inner; }
+    Span<IttType> parameters(IttType function) const { return entry(function, IttType::FUNCTION).members; }
+    Symbol structName(IttType type) const { return Symbol(entry(type, IttType::STRUCT).extra); }
+    Span<IttType> fields(IttType type) const { return entry(type, IttType::STRUCT).members; }
+
+    // Distinct types so far, primitives included; every handle's index is
+    // below this.
+    size_t size() const { return _types.size(); }
+
+    // Source-like spelling, e.g. "Fn(Int, *[Char; 4]) -> Bool".
+    std::string toString(IttType type) const {
+        switch (type.getKind()) {
+            case IttType::POINTER:
+                return "*" + toString(pointee(type));
+            case IttType::ARRAY:
+                return "[" + toString(element(type)) + "; " + std::to_string(length(type)) + "]";
+            case IttType::FUNCTION: {
+                std::string text = "Fn(";
+                Span<IttType> params = parameters(type);
+                for (uint32_t i = 0; i < params.size(); ++i) {
+                    text += (i ? ", " : "") + toString(params[i]);
+                }
+                return text + ") -> " + toString(returnType(type));
+            }
+            case IttType::STRUCT:
+                return std::string(structName(type).str());
+            default:
+                return type.toString();
+        }
+    }
+};
@@ -0,0 +1,285 @@
+#include "type_inference.h"
+
+// Built-in kinds double as the ids of the variables that stand for them.
+static_assert(IttType::INT < 5 && IttType::CHAR < 5 && IttType::BOOL < 5 && IttType::VOID < 5 &&
+              IttType::FLOAT < 5 && IttType::IDENTIFIER >= 5 && IttType::UNRESOLVED >= 5);
+
+static bool isArithmetic(IttBinaryOperation op) {
+    return op == IttBinaryOperation::ADD || op == IttBinaryOperation::SUB ||
+           op == IttBinaryOperation::MUL || op == IttBinaryOperation::DIV;
+}
+
+static bool isOrdering(IttBinaryOperation op) {
+    return op == IttBinaryOperation::LESS_THEN || op == IttBinaryOperation::GREATER_THEN ||
+           op == IttBinaryOperation::LESS_EQUALS || op == IttBinaryOperation::GREATER_EQUALS;
+}
+
+void TypeInference::fail(const std::string& message) const {
+    throw TypeError("In function " + std::string(_function.str()) + ": " + message);
+}
+
+void TypeInference::reset() {
+    _parent.clear();
+    _rank.clear();
+    _bound.clear();
+    for (uint32_t kind = 0; kind < builtinCount; ++kind) {
+        _parent.push_back(kind);
+        _rank.push_back(0);
+        _bound.push_back(IttType(static_cast<IttType::TypeKind>(kind)));
+    }
+    _names.clear();
+    _typed.clear();
+}
+
+uint32_t TypeInference::fresh() {
+    uint32_t var = static_cast<uint32_t>(_parent.size());
+    _parent.push_back(var);
+    _rank.push_back(0);
+    _bound.push_back(IttType(IttType::UNRESOLVED));
+    return var;
+}
+
+uint32_t TypeInference::declared(IttType type) {
+    if (type.getKind() < builtinCount) return type.getKind();
+
+    uint32_t var = fresh();
+    if (!type.isPrimitive()) _bound[var] = type;
+    return var;
+}
+
+// Path halving: every node on the way up is pointed at its grandparent.
+uint32_t TypeInference::find(uint32_t var) {
+    while (_parent[var] != var) {
+        _parent[var] = _parent[_parent[var]];
+        var = _parent[var];
+    }
+    return var;
+}
+
+void TypeInference::unify(uint32_t a, uint32_t b, const char* context) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+
+    IttType bound = _bound[a];
+    if (bound.getKind() == IttType::UNRESOLVED) {
+        bound = _bound[b];
+    } else if (_bound[b].getKind() != IttType::UNRESOLVED && _bound[b] != bound) {
+        fail(std::string("mismatched types in ") + context + ": " + _bound[a].toString() + " and " +
+             _bound[b].toString());
+    }
+
+    if (_rank[a] < _rank[b]) std::swap(a, b);
+    _parent[b] = a;
+    if (_rank[a] == _rank[b]) _rank[a]++;
+    _bound[a] = bound;
+}
+
+uint32_t TypeInference::nameVar(Symbol name) {
+    auto [entry, inserted] = _names.try_emplace(name, 0);
+    if (inserted) entry->second = fresh();
+    return entry->second;
+}
+
+uint32_t TypeInference::inferExpression(IttNode& root) {
+    _work.emplace_back(&root, false);
+
+    while (!_work.empty()) {
+        auto [node, operandsDone] = _work.back();
+        _work.pop_back();
+
+        // Literals are typed on the spot; the rest wait for the solution.
+        IttType::TypeKind literal = IttType::UNRESOLVED;
+        uint32_t var;
+        switch (node->getKind()) {
+            case IttKind::INTEGER: literal = IttType::INT; break;
+            case IttKind::FLOAT: literal = IttType::FLOAT; break;
+            case IttKind::BOOLEAN: literal = IttType::BOOL; break;
+            case IttKind::CHAR: literal = IttType::CHAR; break;
+            case IttKind::IDENTIFIER:
+                var = nameVar(static_cast<IttIdentifierNode*>(node)->getName());
+                break;
+            case IttKind::BINARY_OPERATION: {
+                auto* binary = static_cast<IttBinaryOperationNode*>(node);
+                if (!operandsDone) {
+                    _work.emplace_back(node, true);
+                    _work.emplace_back(&binary->getRhs(), false);
+                    _work.emplace_back(&binary->getLhs(), false);
+                    continue;
+                }
+
+                uint32_t rhs = _values.back();
+                _values.pop_back();
+                uint32_t lhs = _values.back();
+                _values.pop_back();
+
+                IttBinaryOperation op = binary->getOperation();
+                if (op == IttBinaryOperation::AND || op == IttBinaryOperation::OR) {
+                    unify(lhs, IttType::BOOL, "logical operation");
+                    unify(rhs, IttType::BOOL, "logical operation");
+                    var = IttType::BOOL;
+                } else if (op == IttBinaryOperation::SHL) {
+                    unify(lhs, IttType::INT, "shift");
+                    unify(rhs, IttType::INT, "shift");
+                    var = IttType::INT;
+                } else if (isArithmetic(op)) {
+                    unify(lhs, rhs, "arithmetic");
+                    var = lhs;
+                } else {
+                    unify(lhs, rhs, "comparison");
+                    var = IttType::BOOL;
+                }
+                break;
+            }
+            case IttKind::UNARY_OPERATION:
+                if (!operandsDone) {
+                    _work.emplace_back(node, true);
+                    _work.emplace_back(&static_cast<IttUnaryOperationNode*>(node)->getOperand(), false);
+                    continue;
+                }
+                // NEG has the type of its operand, checked to be numeric
+                // once solved.
+                var = _values.back();
+                _values.pop_back();
+                break;
+            case IttKind::CALL: {
+                auto* call = static_cast<IttCallNode*>(node);
+                Span<IttNode*> arguments = call->getArguments();
+                if (!operandsDone) {
+                    _work.emplace_back(node, true);
+                    for (size_t i = arguments.size(); i-- > 0;) {
+                        _work.emplace_back(arguments[i], false);
+                    }
+                    continue;
+                }
+
+                auto callee = _functions.find(call->getCallee());
+                if (callee == _functions.end()) {
+                    fail("call to undeclared function " + std::string(call->getCallee().str()));
+                }
+                const IttFunctionNode& function = *callee->second;
+                Span<std::pair<Symbol, IttType>> parameters = function.getParameters();
+                if (parameters.size() != arguments.size()) {
+                    fail("call to " + std::string(call->getCallee().str()) + " with " +
+                         std::to_string(arguments.size()) + " arguments instead of " +
+                         std::to_string(parameters.size()));
+                }
+
+                // A recursive call shares the variables of the signature
+                // being inferred.
+                bool recursive = call->getCallee() == _function;
+                for (size_t i = arguments.size(); i-- > 0;) {
+                    uint32_t parameter = recursive ? nameVar(parameters[i].first) : declared(parameters[i].second);
+                    unify(_values.back(), parameter, "argument");
+                    _values.pop_back();
+                }
+                if (recursive) {
+                    var = _returnVar;
+                } else {
+                    IttType inferred = function.getType();
+                    var = declared(inferred.getKind() != IttType::UNRESOLVED ? inferred : function.getReturnType());
+                }
+                break;
+            }
+            default:
+                fail("statement used as an expression");
+        }
+
+        if (literal != IttType::UNRESOLVED) {
+            node->setType(IttType(literal));
+            _values.push_back(literal);
+            continue;
+        }
+        _typed.emplace_back(node, var);
+        _values.push_back(var);
+    }
+
+    uint32_t result = _values.back();
+    _values.pop_back();
+    return result;
+}
+
+void TypeInference::inferStatement(IttNode& statement) {
+    switch (statement.getKind()) {
+        case IttKind::VARIABLE: {
+            auto& variable = static_cast<IttVariableNode&>(statement);
+            uint32_t var = inferExpression(variable.getContent());
+            unify(nameVar(variable.getName()), var, "assignment");
+            _typed.emplace_back(&statement, var);
+            break;
+        }
+        case IttKind::RETURN: {
+            auto value = static_cast<IttReturnNode&>(statement).getReturnStmt();
+            uint32_t var = value ? inferExpression(**value) : static_cast<uint32_t>(IttType::VOID);
+            unify(_returnVar, var, "return");
+            _typed.emplace_back(&statement, var);
+            break;
+        }
+        case IttKind::BLOCK:
+            for (IttNode* inner : static_cast<IttBlockNode&>(statement).getStatements()) {
+                inferStatement(*inner);
+            }
+            _typed.emplace_back(&statement, IttType::VOID);
+            break;
+        default:
+            inferExpression(statement);
+    }
+}
+
+void TypeInference::declare(const IttFunctionNode& function) {
+    _functions[function.getName()] = &function;
+}
+
+void TypeInference::run(IttFunctionNode& function) {
+    reset();
+    _function = function.getName();
+    declare(function);
+
+    for (const auto& parameter : function.getParameters()) {
+        unify(nameVar(parameter.first), declared(parameter.second), "parameter");
+    }
+    _returnVar = declared(function.getReturnType());
+
+    inferStatement(function.getBody());
+
+    // A function that never returns a value returns Void.
+    if (_bound[find(_returnVar)].getKind() == IttType::UNRESOLVED) {
+        unify(_returnVar, IttType::VOID, "return");
+    }
+
+    // Children were recorded before their parents, so operand types are
+    // already written when an operation is checked.
+    for (auto [node, var] : _typed) {
+        IttType type = _bound[find(var)];
+        if (type.getKind() == IttType::UNRESOLVED) {
+            if (auto* identifier = ittCast<IttIdentifierNode>(*node)) {
+                fail("cannot infer the type of " + std::string(identifier->getName().str()));
+            }
+            fail("cannot infer the type of an expression");
+        }
+        node->setType(type);
+
+        if (auto* binary = ittCast<IttBinaryOperationNode>(*node)) {
+            IttType::TypeKind operands = binary->getLhs().getType().getKind();
+            bool numeric = operands == IttType::INT || operands == IttType::FLOAT;
+            if ((isArithmetic(binary->getOperation()) && !numeric) ||
+                (isOrdering(binary->getOperation()) && !numeric && operands != IttType::CHAR)) {
+                fail("operation is not defined for " + IttType(operands).toString());
+            }
+        } else if (auto* unary = ittCast<IttUnaryOperationNode>(*node)) {
+            IttType::TypeKind operand = unary->getOperand().getType().getKind();
+            if (operand != IttType::INT && operand != IttType::FLOAT) {
+                fail("negation is not defined for " + IttType(operand).toString());
+            }
+        }
+    }
+
+    for (auto& parameter : function.getParameters()) {
+        IttType type = _bound[find(nameVar(parameter.first))];
+        if (type.getKind() == IttType::UNRESOLVED) {
+            fail("cannot infer the type of parameter " + std::string(parameter.first.str()));
+        }
+        parameter.second = type;
+    }
+    function.setType(_bound[find(_returnVar)]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../itt.h"
+
+class TypeError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Resolves every IttType::UNRESOLVED in a function: identifiers, binary
+// operations, variables, returns and the signature. Each expression gets a
+// type variable, constraints are unified in a union-find with path
+// compression, and the solution is written back in one sweep, so a function
+// costs close to linear time in its node count. Expressions are walked with
+// an explicit stack, so nesting depth is not limited by the call stack.
+//
+// Afterwards an IttFunctionNode's own type is its return type, which is Void
+// when it never returns a value. Throws TypeError on conflicting or
+// uninferable types.
+//
+// Calls are checked against the callee's signature, so every function a call
+// names must be declared first. A callee that was already run contributes its
+// inferred signature, others their declared one.
+class TypeInference {
+    // Variables 0..4 stand for the built-in types themselves.
+    static constexpr uint32_t builtinCount = 5;
+
+    std::vector<uint32_t> _parent;
+    std::vector<uint8_t> _rank;
+    std::vector<IttType> _bound;
+
+    std::unordered_map<Symbol, uint32_t> _names;
+    std::unordered_map<Symbol, const IttFunctionNode*> _functions;
+    std::vector<std::pair<IttNode*, uint32_t>> _typed;
+
+    std::vector<std::pair<IttNode*, bool>> _work;
+    std::vector<uint32_t> _values;
+
+    Symbol _function;
+    uint32_t _returnVar;
+
+    void reset();
+    uint32_t fresh();
+    // A new variable for types the source leaves open, else the built-in.
+    uint32_t declared(IttType type);
+    uint32_t find(uint32_t var);
+    void unify(uint32_t a, uint32_t b, const char* context);
+    uint32_t nameVar(Symbol name);
+
+    uint32_t inferExpression(IttNode& root);
+    void inferStatement(IttNode& statement);
+
+    [[noreturn]] void fail(const std::string& message) const;
+public:
+    void declare(const IttFunctionNode& function);
+    void run(IttFunctionNode& function);
+};
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "type_inference.h"
+
+// A balanced tree of arithmetic and comparisons over one parameter and
+// literals, depth levels deep; the parameter's type is left open.
+static IttNode* generateExpression(Arena& arena, int depth, int seed, Symbol parameter) {
+    if (depth == 0) {
+        if (seed % 5 == 0) return arena.make<IttIdentifierNode>(parameter);
+        return arena.make<IttIntegerNode>(seed);
+    }
+    static const IttBinaryOperation ops[] = {IttBinaryOperation::ADD, IttBinaryOperation::MUL, IttBinaryOperation::SUB};
+    return arena.make<IttBinaryOperationNode>(generateExpression(arena, depth - 1, seed * 3 + 1, parameter),
+                                              generateExpression(arena, depth - 1, seed * 3 + 2, parameter), ops[seed % 3]);
+}
+
+static IttFunctionNode* makeFunction(Arena& arena, Symbol parameter, std::vector<IttNode*> statements) {
+    std::vector<std::pair<Symbol, IttType>> params = {{parameter, IttType(IttType::UNRESOLVED)}};
+    return arena.make<IttFunctionNode>(Symbol::intern("generated"), arena.copy(params), IttType(IttType::UNRESOLVED),
+                                       arena.make<IttBlockNode>(arena.copy(statements)));
+}
+
+// Statements alternate between locals and returns of nested expressions.
+static IttFunctionNode* generateBalanced(Arena& arena, int statements, int depth) {
+    Symbol parameter = Symbol::intern("input");
+    std::vector<IttNode*> body;
+    for (int i = 0; i < statements; ++i) {
+        auto value = generateExpression(arena, depth, i, parameter);
+        if (i % 2 == 0) {
+            body.push_back(arena.make<IttVariableNode>(Symbol::intern("local_" + std::to_string(i % 16)), value));
+        } else {
+            body.push_back(arena.make<IttReturnNode>(value));
+        }
+    }
+    return makeFunction(arena, parameter, body);
+}
+
+// One left-leaning chain: ((input + 0) + 1) + ... nested length levels.
+static IttFunctionNode* generateChain(Arena& arena, int length) {
+    Symbol parameter = Symbol::intern("input");
+    IttNode* expression = arena.make<IttIdentifierNode>(parameter);
+    for (int i = 0; i < length; ++i) {
+        expression = arena.make<IttBinaryOperationNode>(expression, arena.make<IttIntegerNode>(i), IttBinaryOperation::ADD);
+    }
+    return makeFunction(arena, parameter, {arena.make<IttReturnNode>(expression)});
+}
+
+static size_t countNodes(const IttNode& node) {
+    return 1 + visitItt(node, [](const auto& concrete) -> size_t {
+        using Node = std::decay_t<decltype(concrete)>;
+        if constexpr (std::is_same_v<Node, IttBinaryOperationNode>) {
+            return countNodes(concrete.getLhs()) + countNodes(concrete.getRhs());
+        } else if constexpr (std::is_same_v<Node, IttVariableNode>) {
+            return countNodes(concrete.getContent());
+        } else if constexpr (std::is_same_v<Node, IttFunctionNode>) {
+            return countNodes(concrete.getBody());
+        } else if constexpr (std::is_same_v<Node, IttBlockNode>) {
+            size_t count = 0;
+            for (const IttNode* statement : concrete.getStatements()) count += countNodes(*statement);
+            return count;
+        } else if constexpr (std::is_same_v<Node, IttReturnNode>) {
+            return concrete.getReturnStmt() ? countNodes(**concrete.getReturnStmt()) : 0;
+        } else {
+            return 0;
+        }
+    });
+}
+
+static void report(const char* name, IttFunctionNode& function, size_t nodes, int iterations) {
+    TypeInference inference;
+    double best = 1e100;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        inference.run(function);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+
+    std::cout << name << nodes << " nodes, " << best * 1000 << " ms (" << best / nodes * 1e9 << " ns/node)"
+              << (function.getType().getKind() == IttType::INT ? "" : " UNRESOLVED") << "\n";
+}
+
+int main(int argc, char** argv) {
+    int statements = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int depth = argc > 2 ? std::stoi(argv[2]) : 8;
+    int chain = argc > 3 ? std::stoi(argv[3]) : 1000000;
+    int iterations = argc > 4 ? std::stoi(argv[4]) : 5;
+
+    Arena arena;
+    IttFunctionNode* balanced = generateBalanced(arena, statements, depth);
+    report("balanced:  ", *balanced, countNodes(*balanced), iterations);
+
+    // Counted directly: a recursive count would be as deep as the chain.
+    IttFunctionNode* deep = generateChain(arena, chain);
+    report("chain:     ", *deep, 2 * static_cast<size_t>(chain) + 4, iterations);
+
+    return 0;
+}
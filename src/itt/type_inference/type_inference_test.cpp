@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include "../itt_test_helpers.h"
+#include "../type_context.h"
+#include "type_inference.h"
+
+static IttNode& statement(IttFunctionNode& function, size_t index) {
+    return *static_cast<IttBlockNode&>(function.getBody()).getStatements()[index];
+}
+
+TEST(TypeInferenceTest, ResolvesDeclaredSignatureTest) {
+    Arena arena;
+    auto& function = inferred("fn f(x Int) -> Int { y = x * 2; ret y + 1; }", arena);
+
+    EXPECT_EQ(function.getType().getKind(), IttType::INT);
+
+    auto& definition = static_cast<IttVariableNode&>(statement(function, 0));
+    EXPECT_EQ(definition.getType().getKind(), IttType::INT);
+    auto& product = static_cast<IttBinaryOperationNode&>(definition.getContent());
+    EXPECT_EQ(product.getType().getKind(), IttType::INT);
+    EXPECT_EQ(product.getLhs().getType().getKind(), IttType::INT);
+
+    auto& ret = static_cast<IttReturnNode&>(statement(function, 1));
+    auto& sum = static_cast<IttBinaryOperationNode&>(**ret.getReturnStmt());
+    EXPECT_EQ(sum.getLhs().getType().getKind(), IttType::INT);
+    EXPECT_EQ(static_cast<IttBlockNode&>(function.getBody()).getType().getKind(), IttType::VOID);
+}
+
+TEST(TypeInferenceTest, InfersOpenSignatureTest) {
+    Arena arena;
+    auto& function = inferred("fn f(x T, y U) -> R { z = y; ret x < z + 1 && true; }", arena);
+
+    EXPECT_EQ(function.getType().getKind(), IttType::BOOL);
+    EXPECT_EQ(function.getParameters()[0].second.getKind(), IttType::INT);
+    EXPECT_EQ(function.getParameters()[1].second.getKind(), IttType::INT);
+
+    // Only the literal fixes the types of x and of the result.
+    EXPECT_THROW(inferred("fn h(x T, y U) -> Bool { ret x < y; }", arena), TypeError);
+
+    Arena floats;
+    auto& scaled = inferred("fn g(x T) -> R { ret x * 1.5; }", floats);
+    EXPECT_EQ(scaled.getType().getKind(), IttType::FLOAT);
+    EXPECT_EQ(scaled.getParameters()[0].second.getKind(), IttType::FLOAT);
+}
+
+TEST(TypeInferenceTest, KeepsFunctionHashTest) {
+    Arena arena;
+    auto& function = inferred("fn f(x T) -> R { ret x + 1; }", arena);
+
+    // Resolving x in place leaves the hash agreeing with a rebuilt node.
+    IttFunctionNode rebuilt(function.getName(), function.getParameters(), function.getReturnType(),
+                            &function.getBody(), function.getVisibility());
+    EXPECT_EQ(rebuilt.structuralHash(), function.structuralHash());
+    EXPECT_TRUE(rebuilt == function);
+}
+
+TEST(TypeInferenceTest, VoidFunctionTest) {
+    Arena arena;
+    auto& function = inferred("fn f(x Int) -> R { y = x; }", arena);
+    EXPECT_EQ(function.getType().getKind(), IttType::VOID);
+
+    Arena bare;
+    EXPECT_EQ(inferred("fn g() { ret; }", bare).getType().getKind(), IttType::VOID);
+}
+
+TEST(TypeInferenceTest, NegationTest) {
+    Arena arena;
+    auto& function = inferred("fn neg(x Float) -> Float { ret -x; }", arena);
+    auto& ret = static_cast<IttReturnNode&>(statement(function, 0));
+    EXPECT_EQ((*ret.getReturnStmt())->getType().getKind(), IttType::FLOAT);
+    EXPECT_EQ(function.getType().getKind(), IttType::FLOAT);
+
+    // The operand's type flows through, here from the return type.
+    auto& open = inferred("fn f(x T) -> Int { y = -x; ret y; }", arena);
+    EXPECT_EQ(open.getParameters()[0].second.getKind(), IttType::INT);
+
+    EXPECT_THROW(inferred("fn f(x Bool) -> Bool { ret -x; }", arena), TypeError);
+}
+
+TEST(TypeInferenceTest, RejectsConflictsTest) {
+    Arena arena;
+    EXPECT_THROW(inferred("fn f(x Int) -> Float { ret x; }", arena), TypeError);
+    EXPECT_THROW(inferred("fn f(x Int) { ret x; }", arena), TypeError);
+    EXPECT_THROW(inferred("fn f(x Int, y Float) -> Int { ret x + y; }", arena), TypeError);
+    EXPECT_THROW(inferred("fn f(x Int) -> Bool { ret x && true; }", arena), TypeError);
+    EXPECT_THROW(inferred("fn f() -> Bool { ret true + false; }", arena), TypeError);
+    EXPECT_THROW(inferred("fn f(x T) { }", arena), TypeError);
+
+    try {
+        inferred("fn mixed(x Int) -> Int { x = 1.5; ret x; }", arena);
+        FAIL() << "expected a TypeError";
+    } catch (const TypeError& error) {
+        EXPECT_STREQ(error.what(), "In function mixed: mismatched types in assignment: Int and Float");
+    }
+}
+
+TEST(TypeInferenceTest, CallsTest) {
+    Arena arena;
+    auto functions = inferredProgram(
+        "fn twice(x T) -> R { ret x * 2; }\n"
+        "fn f(y T) -> R { z = twice(y) < 4; ret z; }\n"
+        "fn count(n Int) -> R { ret count(n - 1) + 1; }", arena);
+
+    EXPECT_EQ(functions[1]->getParameters()[0].second.getKind(), IttType::INT);
+    EXPECT_EQ(functions[1]->getType().getKind(), IttType::BOOL);
+    EXPECT_EQ(functions[2]->getType().getKind(), IttType::INT);
+
+    EXPECT_THROW(inferredProgram("fn f() -> Int { ret g(); }", arena), TypeError);
+    EXPECT_THROW(inferredProgram("fn g(x Int) -> Int { ret x; } fn f() -> Int { ret g(); }", arena), TypeError);
+    EXPECT_THROW(inferredProgram("fn g(x Int) -> Int { ret x; } fn f() -> Int { ret g(1.5); }", arena), TypeError);
+}
+
+TEST(TypeInferenceTest, DeepNestingTest) {
+    Arena arena;
+    auto x = Symbol::intern("x");
+    IttNode* expression = arena.make<IttIdentifierNode>(x);
+    for (int i = 0; i < 200000; ++i) {
+        expression = arena.make<IttBinaryOperationNode>(expression, arena.make<IttIntegerNode>(i), IttBinaryOperation::ADD);
+    }
+
+    std::vector<IttNode*> statements = {arena.make<IttReturnNode>(expression)};
+    std::vector<std::pair<Symbol, IttType>> params = {{x, IttType(IttType::UNRESOLVED)}};
+    IttFunctionNode function(Symbol::intern("deep"), arena.copy(params), IttType(IttType::UNRESOLVED),
+                             arena.make<IttBlockNode>(arena.copy(statements)));
+
+    TypeInference().run(function);
+    EXPECT_EQ(function.getType().getKind(), IttType::INT);
+    EXPECT_EQ(expression->getType().getKind(), IttType::INT);
+    EXPECT_EQ(function.getParameters()[0].second.getKind(), IttType::INT);
+}
+
+TEST(TypeInferenceTest, CompoundSignatureTest) {
+    Arena arena;
+    TypeContext types;
+    auto p = Symbol::intern("p");
+    auto q = Symbol::intern("q");
+    IttType pointer = types.pointerTo(IttType(IttType::INT));
+
+    std::vector<IttNode*> statements = {
+        arena.make<IttVariableNode>(q, arena.make<IttIdentifierNode>(p)),
+        arena.make<IttReturnNode>(arena.make<IttIdentifierNode>(q)),
+    };
+    std::vector<std::pair<Symbol, IttType>> params = {{p, pointer}};
+    IttFunctionNode function(Symbol::intern("forward"), arena.copy(params), IttType(IttType::UNRESOLVED),
+                             arena.make<IttBlockNode>(arena.copy(statements)));
+
+    TypeInference().run(function);
+    EXPECT_EQ(function.getType(), pointer);
+
+    IttFunctionNode mismatched(Symbol::intern("mismatched"), arena.copy(params), types.pointerTo(IttType(IttType::CHAR)),
+                               arena.make<IttBlockNode>(arena.copy(statements)));
+    EXPECT_THROW(TypeInference().run(mismatched), TypeError);
+}
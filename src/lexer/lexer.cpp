@@ -1,118 +1,156 @@
 #include "lexer.h"
-#include <map>
-
-std::map<std::string, Token::TokenType> reservedTokens = {
-    {"fn", Token::FUNC_LITERAL},
-    {"pub", Token::PUBLIC},
-    {"ret", Token::RETURN},
-    {"if", Token::IF},
-    {"else", Token::ELSE},
-    {"Int", Token::INT_TYPE},
-    {"Float", Token::FLOAT_TYPE},
-    {"Char", Token::CHAR_TYPE},
-    {"Bool", Token::BOOL_TYPE},
-};
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+// Keywords bucketed by length, so an identifier costs at most a few short
+// compares and no static initializer runs at startup.
+static constexpr Token::TokenType reservedTokenType(std::string_view ident) {
+    switch (ident.size()) {
+        case 2:
+            if (ident == "fn") return Token::FUNC_LITERAL;
+            if (ident == "if") return Token::IF;
+            break;
+        case 3:
+            if (ident == "pub") return Token::PUBLIC;
+            if (ident == "ret") return Token::RETURN;
+            if (ident == "Int") return Token::INT_TYPE;
+            break;
+        case 4:
+            if (ident == "else") return Token::ELSE;
+            if (ident == "true") return Token::BOOL;
+            if (ident == "Char") return Token::CHAR_TYPE;
+            if (ident == "Bool") return Token::BOOL_TYPE;
+            break;
+        case 5:
+            if (ident == "false") return Token::BOOL;
+            if (ident == "Float") return Token::FLOAT_TYPE;
+            break;
+    }
+    return Token::IDENTIFICATOR;
+}
+
+static_assert(reservedTokenType("fn") == Token::FUNC_LITERAL);
+static_assert(reservedTokenType("false") == Token::BOOL);
+static_assert(reservedTokenType("fnx") == Token::IDENTIFICATOR);
+
+Token Lexer::invalidToken(size_t length, std::string message) {
+    reportError(currentIndex, std::move(message));
+    Token token = createToken(Token::INVALID, slice(currentIndex, currentIndex + length));
+    currentIndex += length;
+    return token;
+}
 
 Token Lexer::parseNumber() {
     size_t start = currentIndex;
     bool isFloat = false;
 
-    while (isdigit(currentChar()) || currentChar() == '.') {
-        if (currentChar() == '.') {
-            if (isFloat) break; 
-            isFloat = true;
-        }
+    currentIndex += kernels->digits(cursor(), textEnd());
+
+    if (currentChar() == '.') {
+        isFloat = true;
         advanceChar();
+        currentIndex += kernels->digits(cursor(), textEnd());
     }
 
-    std::string number = textToParse.substr(start, currentIndex - start);
+    std::string_view number = slice(start, currentIndex);
+    const char* first = number.data();
+    const char* last = first + number.size();
+
+    if (isFloat) {
+        Token token = createToken(Token::FLOAT, number);
+        if (std::from_chars(first, last, token.floatValue).ec != std::errc()) {
+            reportError(start, "Float literal out of range: " + std::string(number));
+            token.floatValue = 0;
+        }
+        return token;
+    }
 
-    return isFloat ? createToken(Token::FLOAT, number) : createToken(Token::INTEGER, number);
+    Token token = createToken(Token::INTEGER, number);
+    if (std::from_chars(first, last, token.intValue).ec != std::errc()) {
+        reportError(start, "Integer literal does not fit in Int: " + std::string(number));
+        token.intValue = 0;
+    }
+    return token;
 }
 
 Token Lexer::parseIdentificator() {
     size_t start = currentIndex;
 
-    while (isalnum(currentChar()) || currentChar() == '_') {
-         advanceChar();
-    }
-
-    std::string ident = textToParse.substr(start, currentIndex - start);
-
-    if (ident == "true" || ident == "false") {
-        return createToken(Token::BOOL, ident);
-    }
+    currentIndex += kernels->identifier(cursor(), textEnd());
 
-    auto it = reservedTokens.find(ident);
+    std::string_view ident = slice(start, currentIndex);
 
-    if (it != reservedTokens.end()) {
-        return createToken(it->second, ident);
+    Token token = createToken(reservedTokenType(ident), ident);
+    if (token.tokenType == Token::IDENTIFICATOR) {
+        token.symbolId = Symbol::intern(ident).getId();
     }
-
-    return createToken(Token::IDENTIFICATOR, ident);
+    return token;
 }
 
-bool Lexer::parseUnaryOrCombinationOfChars(char curr) {
+bool Lexer::parseUnaryOrCombinationOfChars(char curr, Token& token) {
     switch (curr) {
         case '+': {
-            currentToken = createToken(Token::PLUS, "+");
+            token = createToken(Token::PLUS);
         } break; 
         case '-': {
             if (peekChar() == '>') {
-                currentToken = createToken(Token::ARROW, "->");
+                token = createToken(Token::ARROW);
                 advanceChar();
-            } else { currentToken = createToken(Token::MINUS, "-"); }
+            } else { token = createToken(Token::MINUS); }
         } break;
         case '/': {
-            currentToken = createToken(Token::SLASH, "/");
+            token = createToken(Token::SLASH);
         } break; 
         case '*': {
-            currentToken = createToken(Token::STAR, "*");
+            token = createToken(Token::STAR);
         } break; 
         case '=': {
             if (peekChar() == '=') {
-                currentToken = createToken(Token::DOUBLE_EQ, "==");
+                token = createToken(Token::DOUBLE_EQ);
                 advanceChar();
             } 
-            else { currentToken = createToken(Token::EQ, "="); }
+            else { token = createToken(Token::EQ); }
         } break; 
         case '<': {
             if (peekChar() == '=') {
-                currentToken = createToken(Token::LTE, "<=");
+                token = createToken(Token::LTE);
                 advanceChar();
-            } else { currentToken = createToken(Token::LT, "<"); }
+            } else { token = createToken(Token::LT); }
         } break; 
         case '>': {
             if (peekChar() == '=') {
-                currentToken = createToken(Token::GTE, ">=");
+                token = createToken(Token::GTE);
                 advanceChar();
-            } else { currentToken = createToken(Token::GT, ">"); }
+            } else { token = createToken(Token::GT); }
         } break; 
         case '.': {
-            currentToken = createToken(Token::DOT, ".");
+            token = createToken(Token::DOT);
         } break; 
         case '!': {
             if (peekChar() == '=') {
-                currentToken = createToken(Token::NEQ, "!=");
+                token = createToken(Token::NEQ);
                 advanceChar();
-            } else { currentToken = createToken(Token::EXCLAMATION, "!"); }
+            } else { token = createToken(Token::EXCLAMATION); }
         } break; 
-        case '{': currentToken = createToken(Token::L_CURL_BRACE, "{"); break; 
-        case '}': currentToken = createToken(Token::R_CURL_BRACE, "}"); break; 
-        case '(': currentToken = createToken(Token::L_BRACE, "("); break; 
-        case ')': currentToken = createToken(Token::R_BRACE, ")"); break; 
-        case ';': currentToken = createToken(Token::SEMICOLON, ";"); break; 
+        case '{': token = createToken(Token::L_CURL_BRACE); break; 
+        case '}': token = createToken(Token::R_CURL_BRACE); break; 
+        case '(': token = createToken(Token::L_BRACE); break; 
+        case ')': token = createToken(Token::R_BRACE); break; 
+        case ';': token = createToken(Token::SEMICOLON); break; 
+        case ',': token = createToken(Token::COMMA); break;
         case '&': {
-            if (peekChar() == '&') {
-                currentToken = createToken(Token::AND, "&&");
-                advanceChar();
-            } 
+            if (peekChar() != '&') return false;
+            token = createToken(Token::AND);
+            advanceChar();
         } break; 
-         case '|': {
-            if (peekChar() == '|') {
-                currentToken = createToken(Token::OR, "||");
-                advanceChar();
-            } 
+        case '|': {
+            if (peekChar() != '|') return false;
+            token = createToken(Token::OR);
+            advanceChar();
         } break;
         default:
             return false;
@@ -123,42 +161,208 @@ bool Lexer::parseUnaryOrCombinationOfChars(char curr) {
     return true;
 }
 
-Token const& Lexer::next() {
+Token Lexer::lexToken() {
     skipWhitespace();
 
+    if (currentIndex >= textToParse.size()) {
+        return createToken(Token::END_OF_FILE);
+    }
+
     char ch = currentChar();
-    if (ch == '\0') {
-        throw std::runtime_error("End of input");
+
+    Token token;
+    if (parseUnaryOrCombinationOfChars(ch, token)) {
+        return token;
     }
 
-    if (parseUnaryOrCombinationOfChars(ch)) {
-        return currentToken;
+    if (isdigit(static_cast<unsigned char>(ch))) {
+        return parseNumber();
+    } else if (isalpha(static_cast<unsigned char>(ch)) || ch == '_') {
+        return parseIdentificator();
     }
 
-    if (isdigit(ch)) {
-        currentToken = parseNumber();
-    } else if (isalpha(ch) || ch == '_') {
-        currentToken = parseIdentificator();
+    return invalidToken(1, std::string("Unexpected character: ") + ch);
+}
+
+Token const& Lexer::next() {
+    if (lookaheadSize != 0) {
+        currentToken = lookahead[lookaheadHead];
+        lookaheadHead = (lookaheadHead + 1) & (maxLookahead - 1);
+        lookaheadSize--;
     } else {
-        throw std::runtime_error(std::string("Unexpected character: ") + ch);
+        currentToken = lexToken();
     }
 
     return currentToken;
 }
 
-Token const& Lexer::peek() {
+Token const& Lexer::peek(size_t distance) {
+    if (distance == 0 || distance > maxLookahead) {
+        throw std::out_of_range("Lookahead distance out of range");
+    }
+
+    while (lookaheadSize < distance) {
+        lookahead[(lookaheadHead + lookaheadSize) & (maxLookahead - 1)] = lexToken();
+        lookaheadSize++;
+    }
+
+    return lookahead[(lookaheadHead + distance - 1) & (maxLookahead - 1)];
+}
+
+TokenStream Lexer::tokenizeAll() {
+    TokenStream stream(textToParse);
+    stream.reserve((textToParse.size() - currentIndex) / 4);
+
+    bool reachedEnd = false;
+    for (; lookaheadSize != 0; lookaheadSize--) {
+        const Token& buffered = lookahead[lookaheadHead];
+        lookaheadHead = (lookaheadHead + 1) & (maxLookahead - 1);
 
-    size_t savedIndex = currentIndex;
-    int savedRow = row;
-    int savedCol = col;
-    Token savedToken = currentToken;
+        if (!reachedEnd) {
+            stream.append(buffered);
+            reachedEnd = buffered.tokenType == Token::END_OF_FILE;
+        }
+    }
 
-    next();
+    while (!reachedEnd) {
+        Token token = lexToken();
+        stream.append(token);
+        reachedEnd = token.tokenType == Token::END_OF_FILE;
+    }
 
-    currentIndex = savedIndex;
-    row = savedRow;
-    col = savedCol;
-    currentToken = savedToken;
+    stream.setLines(lines);
+    return stream;
+}
 
-    return currentToken;
-}
\ No newline at end of file
+// Lexes the tokens that start before end, plus END_OF_FILE if the input runs
+// out first. The whitespace run straddling end
+// may be skipped past it, so line starts recorded beyond end are the next
+// chunk's business and get trimmed by the caller.
+void Lexer::lexChunk(size_t end, TokenStream& stream) {
+    for (;;) {
+        Token token = lexToken();
+        if (token.offset >= end) {
+            break;
+        }
+
+        stream.append(token);
+        if (token.tokenType == Token::END_OF_FILE) {
+            break;
+        }
+    }
+}
+
+TokenStream Lexer::tokenizeParallel(unsigned threadCount) {
+    TokenStream stream(textToParse);
+    for (; lookaheadSize != 0; lookaheadSize--) {
+        stream.append(lookahead[lookaheadHead]);
+        lookaheadHead = (lookaheadHead + 1) & (maxLookahead - 1);
+    }
+
+    if (!stream.empty() && stream.kind(stream.size() - 1) == Token::END_OF_FILE) {
+        stream.setLines(lines);
+        return stream;
+    }
+
+    threadCount = std::max(threadCount, 1u);
+    size_t begin = currentIndex;
+    size_t size = textToParse.size();
+
+    std::vector<size_t> boundaries(threadCount + 1, size);
+    boundaries[0] = begin;
+    for (unsigned chunk = 1; chunk < threadCount; ++chunk) {
+        size_t boundary = std::max(begin + (size - begin) * chunk / threadCount, boundaries[chunk - 1]);
+        while (boundary < size && !isspace(static_cast<unsigned char>(textToParse[boundary]))) {
+            boundary++;
+        }
+        boundaries[chunk] = boundary;
+    }
+
+    struct Chunk {
+        TokenStream tokens;
+        std::vector<uint32_t> lineStarts;
+        std::vector<LexError> errors;
+    };
+    std::vector<Chunk> chunks(threadCount);
+
+    auto lexOne = [&](unsigned chunk) {
+        Lexer lexer(SourceBuffer::borrow(textToParse));
+        lexer.kernels = kernels;
+        lexer.currentIndex = boundaries[chunk];
+
+        size_t end = chunk + 1 == threadCount ? SIZE_MAX : boundaries[chunk + 1];
+        lexer.lexChunk(end, chunks[chunk].tokens);
+
+        for (uint32_t lineStart : lexer.lines.lineStarts()) {
+            if (lineStart > boundaries[chunk] && lineStart <= end) chunks[chunk].lineStarts.push_back(lineStart);
+        }
+        for (LexError& error : lexer.errors) {
+            if (error.offset < end) chunks[chunk].errors.push_back(std::move(error));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned chunk = 1; chunk < threadCount; ++chunk) {
+        if (boundaries[chunk] < boundaries[chunk + 1] || chunk + 1 == threadCount) {
+            workers.emplace_back(lexOne, chunk);
+        }
+    }
+    lexOne(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (Chunk& chunk : chunks) {
+        stream.append(chunk.tokens);
+        lines.lineStarts().insert(lines.lineStarts().end(), chunk.lineStarts.begin(), chunk.lineStarts.end());
+        std::move(chunk.errors.begin(), chunk.errors.end(), std::back_inserter(errors));
+    }
+
+    currentIndex = size;
+    stream.setLines(lines);
+    return stream;
+}
+
+void Lexer::relex(TokenStream& tokens, std::string_view newText, const SourceEdit& edit) {
+    uint32_t shift = static_cast<uint32_t>(edit.insertedText.size()) - edit.removedLength;
+    uint32_t newEditEnd = edit.offset + static_cast<uint32_t>(edit.insertedText.size());
+    const std::vector<uint32_t>& offsets = tokens.offsets();
+
+    // Bytes before the last token that starts ahead of the edit are unchanged,
+    // and no earlier token looked past that token's first byte, so lexing can
+    // safely resume there.
+    size_t after = std::lower_bound(offsets.begin(), offsets.end(), edit.offset) - offsets.begin();
+    size_t first = after == 0 ? 0 : after - 1;
+
+    Lexer lexer(SourceBuffer::borrow(newText));
+    lexer.currentIndex = after == 0 ? 0 : offsets[first];
+
+    TokenStream relexed(newText);
+    size_t last = tokens.size();
+
+    for (;;) {
+        Token token = lexer.lexToken();
+
+        // Past the edit the text matches the old one, so the first token that
+        // starts exactly where an old one did is followed by the old tail.
+        if (token.offset >= newEditEnd) {
+            uint32_t oldOffset = token.offset - shift;
+            auto match = std::lower_bound(offsets.begin() + first, offsets.end(), oldOffset);
+            size_t index = match - offsets.begin();
+
+            if (match != offsets.end() && *match == oldOffset && tokens.kind(index) == token.tokenType) {
+                last = index;
+                break;
+            }
+        }
+
+        relexed.append(token);
+        if (token.tokenType == Token::END_OF_FILE) {
+            break;
+        }
+    }
+
+    tokens.replaceRange(first, last, relexed, shift);
+    tokens.setText(newText);
+    tokens.lines().applyEdit(edit.offset, edit.removedLength, edit.insertedText);
+}
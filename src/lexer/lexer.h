@@ -1,117 +1,141 @@
 #pragma once
 #include <iostream>
+#include <stdexcept>
 #include <string.h>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "../utilities/logging/logger_manager/logger_manager.h"
+#include "line_table.h"
+#include "scan_kernels.h"
+#include "source_buffer.h"
+#include "token.h"
+#include "token_stream.h"
+
+struct LexError {
+    uint32_t offset;
+    std::string message;
+};
 
-struct Token {
-    enum TokenType {
-        PLUS = 0,
-        MINUS,
-        SLASH,
-        STAR,
-        DOUBLE_EQ,
-        EQ,
-        LT,
-        GT,
-        LTE,
-        GTE,
-        NEQ,
-        DOT,
-        EXCLAMATION,
-        IDENTIFICATOR,
-
-        INTEGER,
-        FLOAT,
-        CHAR,
-        BOOL,
-
-        FUNC_LITERAL,
-        INT_TYPE,
-        FLOAT_TYPE,
-        CHAR_TYPE,
-        BOOL_TYPE,
-
-        L_CURL_BRACE,
-        R_CURL_BRACE,
-
-        L_BRACE,
-        R_BRACE,
-
-        SEMICOLON,
-
-        RETURN,
-
-        IF,
-        ELSE,
-
-        AND,
-        OR,
-
-        ARROW,
-
-        PUBLIC,
-        PRIVATE
-    };
-
-    int row, col;
-    TokenType tokenType;
-    std::string literal;
+// Replacement of removedLength bytes at offset by insertedText.
+struct SourceEdit {
+    uint32_t offset;
+    uint32_t removedLength;
+    std::string_view insertedText;
 };
 
 class Lexer {
+public:
+    static constexpr size_t maxLookahead = 4;
+    static_assert((maxLookahead & (maxLookahead - 1)) == 0, "lookahead ring indexes with a mask");
 
-    std::string textToParse;
-    int row, col;
+private:
+    SourceBuffer source;
+    std::string_view textToParse;
+    LineTable lines;
     size_t currentIndex;
     Token currentToken;
+    const ScanKernels* kernels;
+
+    // Tokens lexed ahead by peek(), oldest first, so each one is lexed once no
+    // matter how far the parser looks ahead.
+    Token lookahead[maxLookahead];
+    size_t lookaheadHead;
+    size_t lookaheadSize;
+
+    std::vector<LexError> errors;
 
     char currentChar() const {
         return currentIndex < textToParse.size() ? textToParse[currentIndex] : '\0';
     }
 
     void advanceChar() {
-        if (currentChar() == '\n') {
-            row++;
-            col = 0;
-        } else {
-            col++;
-        }
         currentIndex++;
     }
 
-    char peekChar() {
-        advanceChar();
-        int savedRow = row;
-        int savedCol = col;
-        int savedIndex = currentIndex;
+    char peekChar() const {
+        return currentIndex + 1 < textToParse.size() ? textToParse[currentIndex + 1] : '\0';
+    }
 
-        char ret = currentChar();
+    const char* cursor() const { return textToParse.data() + currentIndex; }
+    const char* textEnd() const { return textToParse.data() + textToParse.size(); }
 
-        row = savedRow;
-        col = savedCol;
-        currentIndex = savedIndex;
+    void skipWhitespace() {
+        currentIndex += kernels->whitespace(cursor(), textEnd(), static_cast<uint32_t>(currentIndex), lines.lineStarts());
+    }
 
-        return ret;
+    // A token without text, starting at the current character.
+    Token createToken(Token::TokenType type) {
+        return Token{static_cast<uint32_t>(currentIndex), type, {}, {}};
     }
 
-    void skipWhitespace() {
-        while (isspace(currentChar())) {
-            advanceChar();
-        }
+    // A token spelled by literal, which must view textToParse.
+    Token createToken(Token::TokenType type, std::string_view literal) {
+        return Token{static_cast<uint32_t>(literal.data() - textToParse.data()), type, literal, {}};
     }
 
-    Token createToken(Token::TokenType type, const std::string& literal = "") {
-        return Token{row, col, type, literal};
+    std::string_view slice(size_t start, size_t end) const {
+        return textToParse.substr(start, end - start);
     }
 
+    Token invalidToken(size_t length, std::string message);
+    void reportError(size_t offset, std::string message) {
+        errors.push_back(LexError{static_cast<uint32_t>(offset), std::move(message)});
+    }
     Token parseNumber();
     Token parseIdentificator();
-    bool parseUnaryOrCombinationOfChars(char curr);
+    bool parseUnaryOrCombinationOfChars(char curr, Token& token);
+    Token lexToken();
+    void lexChunk(size_t end, TokenStream& stream);
 public:
-    Lexer(std::string text) : textToParse(std::move(text)), currentIndex(0), row(1), col(1) {}
+    Lexer(std::string text) : Lexer(SourceBuffer(std::move(text))) {}
 
-    Token const& peek();
+    explicit Lexer(SourceBuffer buffer)
+        : source(std::move(buffer)), textToParse(source.text()), currentIndex(0),
+          kernels(&defaultScanKernels()), lookaheadHead(0), lookaheadSize(0) {
+        if (textToParse.size() > UINT32_MAX) {
+            throw std::runtime_error("Source is too large to lex");
+        }
+    }
+
+    // Lexes path straight out of a read-only mapping; "-" reads stdin.
+    static Lexer fromFile(const std::string& path) { return Lexer(SourceBuffer::fromFile(path)); }
+
+    Lexer(Lexer&&) = default;
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+
+    // Swaps the character-class scanners, e.g. to check the vector kernels
+    // against the scalar reference.
+    void setScanKernels(const ScanKernels& scanKernels) { kernels = &scanKernels; }
+
+    // Returns the token that the distance-th call to next() would return,
+    // for distance in [1, maxLookahead]. Valid until next() consumes it.
+    Token const& peek(size_t distance = 1);
 
     Token const& next();
+
+    // Lexes the rest of the input in one go into a contiguous token buffer.
+    TokenStream tokenizeAll();
+
+    // Same stream as tokenizeAll, but the rest of the input is split at
+    // whitespace into threadCount chunks that are lexed concurrently. Tokens
+    // never span whitespace and the lexer keeps no state between tokens, so
+    // the chunks need no fix-up beyond concatenation.
+    TokenStream tokenizeParallel(unsigned threadCount);
+
+    // Brings tokens, lexed from the source as it was before edit, up to date
+    // with newText by re-lexing only from the last token that starts before
+    // the edit until the output lines up with the old stream again; the rest
+    // is kept and shifted. newText must outlive tokens. Errors for re-lexed
+    // INVALID tokens are not collected.
+    static void relex(TokenStream& tokens, std::string_view newText, const SourceEdit& edit);
+
+    // Diagnostics in source order: one for every INVALID token handed out so
+    // far, and one for every INTEGER or FLOAT literal that does not fit its type.
+    const std::vector<LexError>& getErrors() const { return errors; }
+
+    // Row and column of a token or error offset the lexer has already reached.
+    SourceLocation locate(uint32_t offset) const { return lines.locate(offset); }
 };
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "lexer.h"
+#include "streaming_lexer.h"
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+static std::string generateSource(size_t targetBytes) {
+    std::string source;
+    source.reserve(targetBytes + 256);
+
+    for (size_t i = 0; source.size() < targetBytes; ++i) {
+        std::string id = std::to_string(i);
+        source += "pub fn generated_component_compute_" + id + "(input_value Int) -> Int {\n";
+        source += "    scaled_value = input_value * " + id + " + 3.25 - component_offset_" + id + ";\n";
+        source += "    if scaled_value >= 10 && scaled_value != " + id + " || !is_enabled_flag {\n";
+        source += "        ret scaled_value / 2;\n";
+        source += "    } else {\n";
+        source += "        ret input_value <= 0;\n";
+        source += "    }\n";
+        source += "}\n\n";
+    }
+
+    return source;
+}
+
+static size_t lexAll(Lexer& lexer) {
+    size_t tokens = 0;
+    while (lexer.next().tokenType != Token::END_OF_FILE) {
+        ++tokens;
+    }
+    return tokens;
+}
+
+// Mimics a parser that looks three tokens ahead before consuming each one.
+static size_t lexAllWithLookahead(Lexer& lexer) {
+    size_t tokens = 0;
+    for (;;) {
+        lexer.peek(3);
+        if (lexer.next().tokenType == Token::END_OF_FILE) break;
+        ++tokens;
+    }
+    return tokens;
+}
+
+// The old error model: every bad byte unwinds out of next() as an exception.
+// Resuming after each throw stands in for a driver that keeps going.
+static size_t lexAllThrowing(Lexer& lexer) {
+    size_t errors = 0;
+    for (;;) {
+        try {
+            const Token& token = lexer.next();
+            if (token.tokenType == Token::END_OF_FILE) break;
+            if (token.tokenType == Token::INVALID) {
+                throw std::runtime_error(lexer.getErrors().back().message);
+            }
+        } catch (const std::runtime_error&) {
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+static std::vector<Token> collectAll(Lexer& lexer) {
+    std::vector<Token> tokens;
+    for (;;) {
+        const Token& token = lexer.next();
+        if (token.tokenType == Token::END_OF_FILE) break;
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+static long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Lexes one file the way the compiler would: either straight out of the
+// mapping, or (with --copy) after reading it into a std::string first.
+static int benchmarkFile(const std::string& path, bool copy) {
+    auto start = std::chrono::steady_clock::now();
+
+    Lexer lexer = copy
+        ? Lexer(std::string(std::istreambuf_iterator<char>(std::ifstream(path, std::ios::binary).rdbuf()), {}))
+        : Lexer::fromFile(path);
+    size_t tokens = lexAll(lexer);
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << "mode:           " << (copy ? "copy into std::string" : "mmap") << "\n";
+    std::cout << "tokens:         " << tokens << "\n";
+    std::cout << "load+lex time:  " << seconds * 1000 << " ms\n";
+    std::cout << "peak RSS:       " << peakRssKb() / 1024 << " MB\n";
+
+    return 0;
+}
+
+// One-character edits in the middle of a file, re-lexed incrementally versus
+// lexing the edited file from scratch.
+static void benchmarkRelex(const std::string& source) {
+    const int edits = 200;
+    size_t middle = source.find("scaled_value", source.size() / 2) + 3;
+
+    std::string texts[2] = {source, source};
+    texts[1].insert(middle, "x");
+
+    Lexer lexer(texts[0]);
+    TokenStream tokens = lexer.tokenizeAll();
+
+    double relexSeconds = 0;
+    double fullSeconds = 0;
+
+    for (int i = 0; i < edits; ++i) {
+        bool inserting = i % 2 == 0;
+        SourceEdit edit{static_cast<uint32_t>(middle), inserting ? 0u : 1u, inserting ? "x" : ""};
+        const std::string& edited = texts[inserting ? 1 : 0];
+
+        auto start = std::chrono::steady_clock::now();
+        Lexer::relex(tokens, edited, edit);
+        auto end = std::chrono::steady_clock::now();
+        relexSeconds += std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        Lexer fresh(edited);
+        TokenStream freshTokens = fresh.tokenizeAll();
+        end = std::chrono::steady_clock::now();
+        fullSeconds += std::chrono::duration<double>(end - start).count();
+    }
+
+    std::cout << "1 MB edit:      relex " << relexSeconds / edits * 1e6 << " us, full lex "
+              << fullSeconds / edits * 1e6 << " us\n";
+}
+
+// Feeds source through a reader callback, as if it were piped in, and tracks
+// how much of it the streaming lexer holds at once.
+static void benchmarkStreaming(const std::string& source, size_t chunkSize, bool readAhead) {
+    size_t position = 0;
+    StreamingLexer lexer([&](char* buffer, size_t capacity) {
+        size_t count = std::min(capacity, source.size() - position);
+        memcpy(buffer, source.data() + position, count);
+        position += count;
+        return count;
+    }, chunkSize, readAhead);
+
+    size_t peakBuffered = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (lexer.next().tokenType != Token::END_OF_FILE) {
+        peakBuffered = std::max(peakBuffered, lexer.bufferedBytes());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double sizeMb = static_cast<double>(source.size()) / (1 << 20);
+    std::cout << "streaming " << chunkSize / 1024 << " KB" << (readAhead ? " +read-ahead" : "") << ": "
+              << sizeMb / std::chrono::duration<double>(end - start).count() << " MB/s, peak buffered "
+              << peakBuffered / 1024 << " KB\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && std::string(argv[1]) == "--file") {
+        return benchmarkFile(argv[2], argc > 3 && std::string(argv[3]) == "--copy");
+    }
+
+    if (argc > 2 && std::string(argv[1]) == "--generate") {
+        std::ofstream(argv[2], std::ios::binary) << generateSource((argc > 3 ? std::stoul(argv[3]) : 64) << 20);
+        return 0;
+    }
+
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 8;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::string source = generateSource(megabytes << 20);
+    double sizeMb = static_cast<double>(source.size()) / (1 << 20);
+
+    double bestNextSeconds = 1e100;
+    double bestCollectSeconds = 1e100;
+    double bestBatchSeconds = 1e100;
+    size_t tokens = 0;
+    size_t allocations = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        Lexer lexer(source);
+
+        size_t before = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        tokens = lexAll(lexer);
+        auto end = std::chrono::steady_clock::now();
+        allocations = allocationCount.load() - before;
+
+        bestNextSeconds = std::min(bestNextSeconds, std::chrono::duration<double>(end - start).count());
+    }
+
+    for (int i = 0; i < iterations; ++i) {
+        Lexer lexer(source);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Token> collected = collectAll(lexer);
+        auto end = std::chrono::steady_clock::now();
+
+        bestCollectSeconds = std::min(bestCollectSeconds, std::chrono::duration<double>(end - start).count());
+    }
+
+    for (int i = 0; i < iterations; ++i) {
+        Lexer lexer(source);
+
+        auto start = std::chrono::steady_clock::now();
+        TokenStream stream = lexer.tokenizeAll();
+        auto end = std::chrono::steady_clock::now();
+
+        bestBatchSeconds = std::min(bestBatchSeconds, std::chrono::duration<double>(end - start).count());
+    }
+
+    std::cout << "input:          " << sizeMb << " MB, " << tokens << " tokens\n";
+    std::cout << "throughput:     " << sizeMb / bestNextSeconds << " MB/s\n";
+    std::cout << "allocations/MB: " << allocations / sizeMb << "\n";
+    std::cout << "next() loop:    " << tokens / bestCollectSeconds / 1e6 << " Mtokens/s, "
+              << sizeof(Token) << " bytes/token\n";
+    std::cout << "tokenizeAll():  " << tokens / bestBatchSeconds / 1e6 << " Mtokens/s, "
+              << TokenStream::bytesPerToken() << " bytes/token\n";
+
+    double bestPeekSeconds = 1e100;
+    for (int i = 0; i < iterations; ++i) {
+        Lexer lexer(source);
+
+        auto start = std::chrono::steady_clock::now();
+        lexAllWithLookahead(lexer);
+        auto end = std::chrono::steady_clock::now();
+
+        bestPeekSeconds = std::min(bestPeekSeconds, std::chrono::duration<double>(end - start).count());
+    }
+
+    std::cout << "peek(3)+next(): " << sizeMb / bestPeekSeconds << " MB/s\n";
+
+    // Roughly one stray byte per 64 bytes of input.
+    std::string errorSource = source;
+    for (size_t i = 0; i < errorSource.size(); i += 64) {
+        if (isspace(static_cast<unsigned char>(errorSource[i]))) errorSource[i] = '@';
+    }
+
+    double bestChannelSeconds = 1e100;
+    double bestThrowSeconds = 1e100;
+    size_t errorCount = 0;
+    for (int i = 0; i < iterations; ++i) {
+        Lexer channelLexer(errorSource);
+        auto start = std::chrono::steady_clock::now();
+        lexAll(channelLexer);
+        auto end = std::chrono::steady_clock::now();
+        bestChannelSeconds = std::min(bestChannelSeconds, std::chrono::duration<double>(end - start).count());
+        errorCount = channelLexer.getErrors().size();
+
+        Lexer throwingLexer(errorSource);
+        start = std::chrono::steady_clock::now();
+        lexAllThrowing(throwingLexer);
+        end = std::chrono::steady_clock::now();
+        bestThrowSeconds = std::min(bestThrowSeconds, std::chrono::duration<double>(end - start).count());
+    }
+
+    std::cout << "errors:         " << errorCount << " (error channel " << sizeMb / bestChannelSeconds
+              << " MB/s, throw per error " << sizeMb / bestThrowSeconds << " MB/s)\n";
+
+    benchmarkRelex(generateSource(1 << 20));
+
+    for (size_t chunkSize : {size_t(4) << 10, size_t(64) << 10}) {
+        benchmarkStreaming(source, chunkSize, false);
+        benchmarkStreaming(source, chunkSize, true);
+    }
+
+    unsigned maxThreads = argc > 3 ? std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double bestSeconds = 1e100;
+        for (int i = 0; i < iterations; ++i) {
+            Lexer lexer(source);
+
+            auto start = std::chrono::steady_clock::now();
+            TokenStream stream = lexer.tokenizeParallel(threads);
+            auto end = std::chrono::steady_clock::now();
+
+            bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(end - start).count());
+        }
+
+        std::cout << "parallel x" << threads << ":" << std::string(threads < 10 ? 5 : 4, ' ')
+                  << sizeMb / bestSeconds << " MB/s\n";
+    }
+
+    for (const ScanKernels* kernels : {&scalarScanKernels(), sse2ScanKernels(), avx2ScanKernels()}) {
+        if (!kernels) continue;
+
+        double bestSeconds = 1e100;
+        for (int i = 0; i < iterations; ++i) {
+            Lexer lexer(source);
+            lexer.setScanKernels(*kernels);
+
+            auto start = std::chrono::steady_clock::now();
+            TokenStream stream = lexer.tokenizeAll();
+            auto end = std::chrono::steady_clock::now();
+
+            bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(end - start).count());
+        }
+
+        std::cout << "kernels " << kernels->name << ":" << std::string(7 - strlen(kernels->name), ' ')
+                  << sizeMb / bestSeconds << " MB/s\n";
+    }
+
+    return 0;
+}
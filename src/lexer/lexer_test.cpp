@@ -1,30 +1,34 @@
 #include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <unistd.h>
 #include "../utilities/logging/logger_manager/logger_manager.h"
 #include "../utilities/logging/console_logger/console_logger.h"
 #include "lexer.h"
+#include "streaming_lexer.h"
 
 
-Token createToken(Token::TokenType type, const std::string& literal = "") {
-        return Token{0, 0, type, literal};
+Token createToken(Token::TokenType type, std::string_view literal = {}) {
+        return Token{0, type, literal, {}};
 }
 
 TEST(LexerTest, SingleCharsLexTest) {
     Lexer lex("* + - / = > < ! . { } ( )");
 
     std::vector<Token> checkSequence = {
-         createToken(Token::STAR, "*"),
-        createToken(Token::PLUS, "+"),
-        createToken(Token::MINUS, "-"),
-        createToken(Token::SLASH, "/"),
-        createToken(Token::EQ, "="),
-        createToken(Token::GT, ">"),
-        createToken(Token::LT, "<"),
-        createToken(Token::EXCLAMATION, "!"),
-        createToken(Token::DOT, "."),
-        createToken(Token::L_CURL_BRACE, "{"),
-        createToken(Token::R_CURL_BRACE, "}"),
-        createToken(Token::L_BRACE, "("),
-        createToken(Token::R_BRACE, ")"),
+         createToken(Token::STAR),
+        createToken(Token::PLUS),
+        createToken(Token::MINUS),
+        createToken(Token::SLASH),
+        createToken(Token::EQ),
+        createToken(Token::GT),
+        createToken(Token::LT),
+        createToken(Token::EXCLAMATION),
+        createToken(Token::DOT),
+        createToken(Token::L_CURL_BRACE),
+        createToken(Token::R_CURL_BRACE),
+        createToken(Token::L_BRACE),
+        createToken(Token::R_BRACE),
     };
 
     for(auto& tok: checkSequence) {
@@ -38,13 +42,13 @@ TEST(LexerTest, CombinationCharsLexTest) {
     Lexer lex("-> == != >= <= && ||");
 
     std::vector<Token> checkSequence = {
-        createToken(Token::ARROW, "->"),
-        createToken(Token::DOUBLE_EQ, "=="),
-        createToken(Token::NEQ, "!="),
-        createToken(Token::GTE, ">="),
-        createToken(Token::LTE, "<="),
-        createToken(Token::AND, "&&"),
-        createToken(Token::OR, "||"),
+        createToken(Token::ARROW),
+        createToken(Token::DOUBLE_EQ),
+        createToken(Token::NEQ),
+        createToken(Token::GTE),
+        createToken(Token::LTE),
+        createToken(Token::AND),
+        createToken(Token::OR),
     };
 
     for(auto& tok: checkSequence) {
@@ -94,4 +98,448 @@ TEST(LexerTest, NumericLexTest) {
         ASSERT_EQ(tok.literal, toEq.literal);
         ASSERT_EQ(tok.tokenType, toEq.tokenType);
     }
-}
\ No newline at end of file
+}
+
+TEST(LexerTest, LiteralsViewSourceTest) {
+    Lexer lex("counter 42 ;");
+
+    Token ident = lex.next();
+    Token number = lex.next();
+    Token semicolon = lex.next();
+
+    ASSERT_EQ(ident.literal, "counter");
+    ASSERT_EQ(number.literal, "42");
+    ASSERT_TRUE(semicolon.literal.empty());
+    ASSERT_EQ(ident.literal.data() + 8, number.literal.data());
+}
+
+TEST(LexerTest, MappedFileLexTest) {
+    char path[] = "/tmp/comodot_lexer_testXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    std::string text = "fn main ret 10";
+    ASSERT_EQ(write(fd, text.data(), text.size()), (ssize_t)text.size());
+    close(fd);
+
+    Lexer lex = Lexer::fromFile(path);
+    unlink(path);
+
+    ASSERT_EQ(lex.next().tokenType, Token::FUNC_LITERAL);
+    ASSERT_EQ(lex.next().literal, "main");
+    ASSERT_EQ(lex.next().tokenType, Token::RETURN);
+    ASSERT_EQ(lex.next().literal, "10");
+}
+
+TEST(LexerTest, PipeFallbackLexTest) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::string text = "pub fn";
+    ASSERT_EQ(write(fds[1], text.data(), text.size()), (ssize_t)text.size());
+    close(fds[1]);
+
+    SourceBuffer buffer = SourceBuffer::fromDescriptor(fds[0]);
+    close(fds[0]);
+
+    ASSERT_FALSE(buffer.isMapped());
+    Lexer lex(std::move(buffer));
+    ASSERT_EQ(lex.next().tokenType, Token::PUBLIC);
+    ASSERT_EQ(lex.next().tokenType, Token::FUNC_LITERAL);
+}
+
+TEST(LexerTest, TokenizeAllMatchesNextTest) {
+    std::string text = "pub fn sum(a Int) -> Int {\n  ret a + 10.5 >= b && !c;\n}";
+    Lexer batchLexer(text);
+    TokenStream stream = batchLexer.tokenizeAll();
+
+    Lexer lex(text);
+    size_t index = 0;
+    for (;; ++index) {
+        Token expected = lex.next();
+        ASSERT_LT(index, stream.size());
+        ASSERT_EQ(stream.kind(index), expected.tokenType);
+        ASSERT_EQ(stream.literal(index), expected.literal);
+        ASSERT_EQ(stream.offset(index), expected.offset);
+        if (expected.tokenType == Token::END_OF_FILE) break;
+    }
+
+    ASSERT_EQ(index + 1, stream.size());
+    ASSERT_EQ(stream.offset(0), 0u);
+    ASSERT_EQ(stream.literal(2), "sum");
+    ASSERT_EQ(stream.offset(2), 7u);
+}
+
+static std::string randomSource(std::mt19937& rng, size_t length) {
+    static const std::string pieces[] = {
+        " ", "  ", "\n", "\t", "\r\n", "\n\n   \n", "                                        ",
+        "a", "_", "Z", "identifier_", "very_long_generated_identifier_name_0123456789",
+        "0", "42", "3.14", "1234567890123456789012345678901234567890", "7.", "1.2.3",
+        "fn", "pub", "ret", "Int", "true", "+", "->", "==", "<=", "!", "{", "}", "(", ")", ";",
+    };
+    std::uniform_int_distribution<size_t> pick(0, std::size(pieces) - 1);
+
+    std::string text;
+    while (text.size() < length) {
+        text += pieces[pick(rng)];
+    }
+    return text;
+}
+
+static void expectSameStreams(const TokenStream& expected, const TokenStream& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(expected.kind(i), actual.kind(i)) << "token " << i;
+        ASSERT_EQ(expected.offset(i), actual.offset(i)) << "token " << i;
+        ASSERT_EQ(expected.length(i), actual.length(i)) << "token " << i;
+    }
+    ASSERT_EQ(expected.lines().lineStarts(), actual.lines().lineStarts());
+}
+
+TEST(LexerTest, VectorKernelsMatchScalarTest) {
+    std::vector<const ScanKernels*> candidates = {sse2ScanKernels(), avx2ScanKernels()};
+    std::mt19937 rng(12345);
+
+    for (int round = 0; round < 200; ++round) {
+        std::string text = randomSource(rng, 1 + rng() % 2048);
+
+        Lexer reference(text);
+        reference.setScanKernels(scalarScanKernels());
+        TokenStream expected = reference.tokenizeAll();
+
+        for (const ScanKernels* kernels : candidates) {
+            if (!kernels) continue;
+            SCOPED_TRACE(kernels->name);
+
+            Lexer lex(text);
+            lex.setScanKernels(*kernels);
+            expectSameStreams(expected, lex.tokenizeAll());
+        }
+    }
+}
+
+TEST(LexerTest, VectorKernelsMatchScalarAtEveryOffsetTest) {
+    std::string text = "  \n \t\n\n    \r\n  x" + std::string(70, 'a') + "_9" + std::string(40, '7') + ".";
+    const ScanKernels& scalar = scalarScanKernels();
+
+    for (const ScanKernels* kernels : {sse2ScanKernels(), avx2ScanKernels()}) {
+        if (!kernels) continue;
+        SCOPED_TRACE(kernels->name);
+
+        for (size_t begin = 0; begin < text.size(); ++begin) {
+            for (size_t end = begin; end <= text.size(); end += 7) {
+                const char* b = text.data() + begin;
+                const char* e = text.data() + end;
+
+                std::vector<uint32_t> expectedLines, actualLines;
+                ASSERT_EQ(scalar.whitespace(b, e, 7, expectedLines), kernels->whitespace(b, e, 7, actualLines));
+                ASSERT_EQ(expectedLines, actualLines);
+                ASSERT_EQ(scalar.identifier(b, e), kernels->identifier(b, e));
+                ASSERT_EQ(scalar.digits(b, e), kernels->digits(b, e));
+            }
+        }
+    }
+}
+
+TEST(LexerTest, KeywordNearMissesLexTest) {
+    Lexer lex("ret fnx f int Truex else_ Floats");
+
+    ASSERT_EQ(lex.next().tokenType, Token::RETURN);
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_EQ(lex.next().tokenType, Token::IDENTIFICATOR);
+    }
+}
+
+TEST(LexerTest, PeekLookaheadTest) {
+    Lexer lex("pub fn name ( ) -> Int");
+
+    ASSERT_EQ(lex.peek().tokenType, Token::PUBLIC);
+    ASSERT_EQ(lex.peek(3).literal, "name");
+    ASSERT_EQ(lex.peek(2).tokenType, Token::FUNC_LITERAL);
+    ASSERT_EQ(lex.peek(4).tokenType, Token::L_BRACE);
+    ASSERT_THROW(lex.peek(Lexer::maxLookahead + 1), std::out_of_range);
+
+    ASSERT_EQ(lex.next().tokenType, Token::PUBLIC);
+    ASSERT_EQ(lex.next().tokenType, Token::FUNC_LITERAL);
+    ASSERT_EQ(lex.peek(4).tokenType, Token::ARROW);
+    ASSERT_EQ(lex.next().literal, "name");
+    ASSERT_EQ(lex.next().tokenType, Token::L_BRACE);
+
+    TokenStream rest = lex.tokenizeAll();
+    ASSERT_EQ(rest.size(), 4u);
+    ASSERT_EQ(rest.kind(0), Token::R_BRACE);
+    ASSERT_EQ(rest.kind(1), Token::ARROW);
+    ASSERT_EQ(rest.literal(2), "Int");
+    ASSERT_EQ(rest.offset(2), 19u);
+    ASSERT_EQ(rest.kind(3), Token::END_OF_FILE);
+}
+
+TEST(LexerTest, AdjacentOperatorsLexTest) {
+    Lexer lex("a-b->c>=d");
+
+    std::vector<Token::TokenType> expected = {
+        Token::IDENTIFICATOR, Token::MINUS, Token::IDENTIFICATOR, Token::ARROW,
+        Token::IDENTIFICATOR, Token::GTE, Token::IDENTIFICATOR,
+    };
+
+    for (auto type : expected) {
+        ASSERT_EQ(lex.next().tokenType, type);
+    }
+    ASSERT_EQ(lex.next().tokenType, Token::END_OF_FILE);
+}
+
+TEST(LexerTest, EndOfFileIsStickyTest) {
+    Lexer lex("  x \n ");
+
+    ASSERT_EQ(lex.next().tokenType, Token::IDENTIFICATOR);
+    ASSERT_EQ(lex.peek(3).tokenType, Token::END_OF_FILE);
+    ASSERT_EQ(lex.next().tokenType, Token::END_OF_FILE);
+    ASSERT_EQ(lex.next().tokenType, Token::END_OF_FILE);
+    ASSERT_EQ(lex.tokenizeAll().size(), 1u);
+}
+
+TEST(LexerTest, InvalidCharactersAreReportedTest) {
+    Lexer lex("a @ b\n & c # ;");
+    TokenStream stream = lex.tokenizeAll();
+
+    std::vector<Token::TokenType> expected = {
+        Token::IDENTIFICATOR, Token::INVALID, Token::IDENTIFICATOR, Token::INVALID,
+        Token::IDENTIFICATOR, Token::INVALID, Token::SEMICOLON, Token::END_OF_FILE,
+    };
+
+    ASSERT_EQ(stream.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(stream.kind(i), expected[i]);
+    }
+    ASSERT_EQ(stream.literal(1), "@");
+    ASSERT_EQ(stream.literal(3), "&");
+
+    const auto& errors = lex.getErrors();
+    ASSERT_EQ(errors.size(), 3u);
+    ASSERT_EQ(errors[0].message, "Unexpected character: @");
+    ASSERT_EQ(lex.locate(errors[1].offset).row, 2);
+    ASSERT_EQ(lex.locate(errors[1].offset).col, 2);
+    ASSERT_EQ(errors[2].message, "Unexpected character: #");
+}
+
+TEST(LexerTest, LazyLocationTest) {
+    Lexer lex("fn\n  main\n\n\tret 1;");
+    TokenStream stream = lex.tokenizeAll();
+
+    ASSERT_EQ(stream.lines().lineCount(), 4u);
+    ASSERT_EQ(stream.location(0).row, 1);
+    ASSERT_EQ(stream.location(0).col, 1);
+    ASSERT_EQ(stream.location(1).row, 2);
+    ASSERT_EQ(stream.location(1).col, 3);
+    ASSERT_EQ(stream.location(2).row, 4);
+    ASSERT_EQ(stream.location(2).col, 2);
+    ASSERT_EQ(stream.location(4).col, 7);
+    ASSERT_EQ(lex.locate(stream.offset(3)).col, 6);
+}
+
+static std::string applyEdit(const std::string& text, const SourceEdit& edit) {
+    std::string edited = text;
+    edited.replace(edit.offset, edit.removedLength, edit.insertedText);
+    return edited;
+}
+
+TEST(LexerTest, RelexSingleEditTest) {
+    std::string text = "fn a() -> Int {\n  ret b - c;\n}";
+    Lexer lex(text);
+    TokenStream tokens = lex.tokenizeAll();
+
+    SourceEdit edit{25, 1, ">\n"};
+    std::string edited = applyEdit(text, edit);
+    Lexer::relex(tokens, edited, edit);
+
+    Lexer fresh(edited);
+    expectSameStreams(fresh.tokenizeAll(), tokens);
+    ASSERT_EQ(tokens.kind(9), Token::ARROW);
+    ASSERT_EQ(tokens.literal(10), "c");
+    ASSERT_EQ(tokens.location(10).row, 3);
+}
+
+TEST(LexerTest, RelexMatchesFreshLexTest) {
+    std::mt19937 rng(777);
+    static const std::string insertions[] = {"", "x", " ", "\n", "->", "1.5", "==", "fn", "  \n\n ", "@", ">"};
+
+    for (int round = 0; round < 300; ++round) {
+        std::string text = randomSource(rng, 1 + rng() % 512);
+        Lexer lex(text);
+        TokenStream tokens = lex.tokenizeAll();
+
+        for (int step = 0; step < 5; ++step) {
+            uint32_t offset = rng() % (text.size() + 1);
+            uint32_t removed = std::min<uint32_t>(rng() % 6, text.size() - offset);
+            SourceEdit edit{offset, removed, insertions[rng() % std::size(insertions)]};
+
+            std::string edited = applyEdit(text, edit);
+            Lexer::relex(tokens, edited, edit);
+
+            Lexer fresh(edited);
+            expectSameStreams(fresh.tokenizeAll(), tokens);
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                ASSERT_EQ(tokens.literal(i).data(), edited.data() + tokens.offset(i));
+            }
+
+            text = std::move(edited);
+        }
+    }
+}
+
+TEST(LexerTest, ParallelMatchesSerialTest) {
+    std::mt19937 rng(4242);
+
+    for (int round = 0; round < 100; ++round) {
+        std::string text = randomSource(rng, 1 + rng() % 4096);
+        if (round % 3 == 0) text[rng() % text.size()] = '@';
+
+        Lexer serial(text);
+        TokenStream expected = serial.tokenizeAll();
+
+        for (unsigned threads : {1u, 2u, 3u, 8u, 64u}) {
+            SCOPED_TRACE(threads);
+            Lexer parallel(text);
+            expectSameStreams(expected, parallel.tokenizeParallel(threads));
+
+            ASSERT_EQ(serial.getErrors().size(), parallel.getErrors().size());
+            for (size_t i = 0; i < serial.getErrors().size(); ++i) {
+                ASSERT_EQ(serial.getErrors()[i].offset, parallel.getErrors()[i].offset);
+            }
+        }
+    }
+}
+
+TEST(LexerTest, ParallelAfterPeekTest) {
+    Lexer lex("pub fn main ( ) { ret 1 ; }");
+    ASSERT_EQ(lex.next().tokenType, Token::PUBLIC);
+    ASSERT_EQ(lex.peek(2).literal, "main");
+
+    TokenStream rest = lex.tokenizeParallel(4);
+    ASSERT_EQ(rest.size(), 10u);
+    ASSERT_EQ(rest.kind(0), Token::FUNC_LITERAL);
+    ASSERT_EQ(rest.kind(9), Token::END_OF_FILE);
+}
+
+TEST(LexerTest, NumericValuesTest) {
+    std::string tiny = "0." + std::string(60, '0') + "1";
+    Lexer lex("0 42 2147483647 2147483648 3.5 7. 1" + std::string(40, '0') + ".0 " + tiny);
+    TokenStream stream = lex.tokenizeAll();
+
+    ASSERT_EQ(stream.intValue(0), 0);
+    ASSERT_EQ(stream.intValue(1), 42);
+    ASSERT_EQ(stream.intValue(2), 2147483647);
+    ASSERT_EQ(stream.kind(3), Token::INTEGER);
+    ASSERT_EQ(stream.intValue(3), 0);
+    ASSERT_FLOAT_EQ(stream.floatValue(4), 3.5f);
+    ASSERT_FLOAT_EQ(stream.floatValue(5), 7.0f);
+    ASSERT_EQ(stream.token(4).floatValue, 3.5f);
+
+    const auto& errors = lex.getErrors();
+    ASSERT_EQ(errors.size(), 3u);
+    ASSERT_EQ(errors[0].offset, stream.offset(3));
+    ASSERT_EQ(errors[0].message, "Integer literal does not fit in Int: 2147483648");
+    ASSERT_EQ(errors[1].offset, stream.offset(6));
+    ASSERT_EQ(errors[2].offset, stream.offset(7));
+}
+
+TEST(LexerTest, IdentifierSymbolsTest) {
+    Lexer lex("total = total + other; fn");
+    TokenStream stream = lex.tokenizeAll();
+
+    ASSERT_EQ(stream.symbol(0), stream.symbol(2));
+    ASSERT_NE(stream.symbol(0), stream.symbol(4));
+    ASSERT_EQ(stream.symbol(4), Symbol::intern("other"));
+    ASSERT_EQ(stream.symbol(0).str(), "total");
+    ASSERT_TRUE(stream.symbol(6).empty());
+
+    Lexer single("total");
+    ASSERT_EQ(Symbol(single.next().symbolId), stream.symbol(0));
+}
+
+static StreamingLexer::Reader stringReader(const std::string& text) {
+    return [&text, position = size_t(0)](char* buffer, size_t capacity) mutable {
+        size_t count = std::min(capacity, text.size() - position);
+        memcpy(buffer, text.data() + position, count);
+        position += count;
+        return count;
+    };
+}
+
+TEST(LexerTest, StreamingMatchesTokenizeAllTest) {
+    std::mt19937 rng(2024);
+
+    for (int round = 0; round < 40; ++round) {
+        std::string text = randomSource(rng, 2000);
+        for (size_t i = round; i < text.size(); i += 97) text[i] = '@';
+
+        Lexer lex(text);
+        TokenStream expected = lex.tokenizeAll();
+
+        for (size_t chunkSize : {1, 3, 7, 64, 4096}) {
+            StreamingLexer streaming(stringReader(text), chunkSize, round % 2 == 0);
+
+            for (size_t i = 0; i < expected.size(); ++i) {
+                if (i % 5 == 0) streaming.peek(3);
+                const Token& token = streaming.next();
+                ASSERT_EQ(token.tokenType, expected.kind(i)) << "chunk " << chunkSize << ", token " << i;
+                ASSERT_EQ(token.offset, expected.offset(i)) << "chunk " << chunkSize << ", token " << i;
+                ASSERT_EQ(token.literal, expected.literal(i)) << "chunk " << chunkSize << ", token " << i;
+                ASSERT_EQ(streaming.locate(token.offset).row, expected.location(i).row);
+                ASSERT_EQ(streaming.locate(token.offset).col, expected.location(i).col);
+            }
+            ASSERT_EQ(streaming.next().tokenType, Token::END_OF_FILE);
+
+            ASSERT_EQ(streaming.getErrors().size(), lex.getErrors().size());
+            for (size_t i = 0; i < lex.getErrors().size(); ++i) {
+                ASSERT_EQ(streaming.getErrors()[i].offset, lex.getErrors()[i].offset);
+                ASSERT_EQ(streaming.getErrors()[i].message, lex.getErrors()[i].message);
+            }
+        }
+    }
+}
+
+TEST(LexerTest, StreamingMemoryIsBoundedTest) {
+    const std::string line = "pub fn f(a Int) -> Int { ret a + 1; }\n";
+    const size_t lines = 50000;
+
+    size_t produced = 0;
+    StreamingLexer streaming([&](char* buffer, size_t capacity) {
+        size_t count = 0;
+        while (produced < lines && count + line.size() <= capacity) {
+            memcpy(buffer + count, line.data(), line.size());
+            count += line.size();
+            produced++;
+        }
+        return count;
+    }, 1024);
+
+    size_t tokens = 0;
+    size_t peakBuffered = 0;
+    int lastRow = 0;
+    for (;;) {
+        const Token& token = streaming.next();
+        if (token.tokenType == Token::END_OF_FILE) break;
+        tokens++;
+        peakBuffered = std::max(peakBuffered, streaming.bufferedBytes());
+        lastRow = streaming.locate(token.offset).row;
+    }
+
+    ASSERT_EQ(tokens, lines * 16);
+    ASSERT_LE(peakBuffered, 4096u);
+    ASSERT_EQ(lastRow, static_cast<int>(lines));
+}
+
+TEST(LexerTest, StreamingReadsDescriptorTest) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    const std::string text = "fn main() -> Int {\n    ret 42;\n}\n";
+    ASSERT_EQ(write(fds[1], text.data(), text.size()), static_cast<ssize_t>(text.size()));
+    close(fds[1]);
+
+    StreamingLexer streaming(fds[0], 5);
+    std::vector<Token::TokenType> kinds;
+    while (streaming.next().tokenType != Token::END_OF_FILE) kinds.push_back(streaming.peek(1).tokenType);
+    close(fds[0]);
+
+    ASSERT_EQ(kinds.size(), 11u);
+    ASSERT_EQ(kinds.back(), Token::END_OF_FILE);
+}
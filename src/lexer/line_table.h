@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct SourceLocation {
+    int row, col;
+};
+
+// Sorted offsets of the first byte of every line, recorded while the lexer
+// skips whitespace. Tokens only carry a byte offset; rows and columns are
+// recovered here, by binary search, when a diagnostic actually needs them.
+class LineTable {
+    std::vector<uint32_t> _lineStarts;
+
+  public:
+    LineTable() : _lineStarts{0} {}
+
+    std::vector<uint32_t>& lineStarts() { return _lineStarts; }
+    const std::vector<uint32_t>& lineStarts() const { return _lineStarts; }
+
+    size_t lineCount() const { return _lineStarts.size(); }
+
+    // Keeps the table in step with replacing removedLength bytes at offset by
+    // inserted: line starts inside the removed range go, those in inserted
+    // are added, and everything after is shifted.
+    void applyEdit(uint32_t offset, uint32_t removedLength, std::string_view inserted) {
+        auto first = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset);
+        auto last = std::upper_bound(first, _lineStarts.end(), offset + removedLength);
+
+        std::vector<uint32_t> added;
+        for (size_t i = 0; i < inserted.size(); ++i) {
+            if (inserted[i] == '\n') added.push_back(offset + static_cast<uint32_t>(i) + 1);
+        }
+
+        uint32_t shift = static_cast<uint32_t>(inserted.size()) - removedLength;
+        for (auto it = last; it != _lineStarts.end(); ++it) {
+            *it += shift;
+        }
+
+        size_t index = first - _lineStarts.begin();
+        _lineStarts.erase(first, last);
+        _lineStarts.insert(_lineStarts.begin() + index, added.begin(), added.end());
+    }
+
+    // 1-based row and column of offset. Only exact for offsets the lexer has
+    // already moved past.
+    SourceLocation locate(uint32_t offset) const {
+        auto line = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset) - 1;
+        return SourceLocation{
+            static_cast<int>(line - _lineStarts.begin()) + 1,
+            static_cast<int>(offset - *line) + 1,
+        };
+    }
+};
@@ -0,0 +1,209 @@
+#include "scan_kernels.h"
+
+#include <cctype>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMODOT_X86_KERNELS 1
+#endif
+
+static size_t scalarWhitespace(const char* begin, const char* end, uint32_t baseOffset, std::vector<uint32_t>& lineStarts) {
+    const char* ptr = begin;
+
+    while (ptr != end && isspace(static_cast<unsigned char>(*ptr))) {
+        if (*ptr == '\n') {
+            lineStarts.push_back(baseOffset + static_cast<uint32_t>(ptr - begin) + 1);
+        }
+        ptr++;
+    }
+
+    return ptr - begin;
+}
+
+static size_t scalarIdentifier(const char* begin, const char* end) {
+    const char* ptr = begin;
+    while (ptr != end && (isalnum(static_cast<unsigned char>(*ptr)) || *ptr == '_')) {
+        ptr++;
+    }
+    return ptr - begin;
+}
+
+static size_t scalarDigits(const char* begin, const char* end) {
+    const char* ptr = begin;
+    while (ptr != end && isdigit(static_cast<unsigned char>(*ptr))) {
+        ptr++;
+    }
+    return ptr - begin;
+}
+
+// Records the newlines of one vector, already cut at the end of the run;
+// offset is the position of the vector relative to baseOffset.
+static inline void recordNewlines(unsigned newlineMask, uint32_t offset, std::vector<uint32_t>& lineStarts) {
+    while (newlineMask != 0) {
+        lineStarts.push_back(offset + __builtin_ctz(newlineMask) + 1);
+        newlineMask &= newlineMask - 1;
+    }
+}
+
+#ifdef COMODOT_X86_KERNELS
+
+// Unsigned lo <= c <= hi, in the min/cmpeq form SSE2 supports.
+static inline __m128i inRange128(__m128i chars, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(chars, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(static_cast<char>(hi - lo))), shifted);
+}
+
+static inline __m128i whitespace128(__m128i chars) {
+    return _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), inRange128(chars, '\t', '\r'));
+}
+
+static inline __m128i identifier128(__m128i chars) {
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    return _mm_or_si128(
+        _mm_or_si128(inRange128(lower, 'a', 'z'), inRange128(chars, '0', '9')),
+        _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+}
+
+static size_t sse2Whitespace(const char* begin, const char* end, uint32_t baseOffset, std::vector<uint32_t>& lineStarts) {
+    const char* ptr = begin;
+
+    while (end - ptr >= 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(whitespace128(chars))) & 0xFFFF;
+        unsigned newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')));
+        size_t count = stop ? __builtin_ctz(stop) : 16;
+
+        if (count < 16) newlines &= (1u << count) - 1;
+        size_t offset = ptr - begin;
+        recordNewlines(newlines, baseOffset + static_cast<uint32_t>(offset), lineStarts);
+
+        if (count < 16) return offset + count;
+        ptr += 16;
+    }
+
+    return (ptr - begin) + scalarWhitespace(ptr, end, baseOffset + static_cast<uint32_t>(ptr - begin), lineStarts);
+}
+
+static size_t sse2Identifier(const char* begin, const char* end) {
+    const char* ptr = begin;
+
+    while (end - ptr >= 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(identifier128(chars))) & 0xFFFF;
+        if (stop) return (ptr - begin) + __builtin_ctz(stop);
+        ptr += 16;
+    }
+
+    return (ptr - begin) + scalarIdentifier(ptr, end);
+}
+
+static size_t sse2Digits(const char* begin, const char* end) {
+    const char* ptr = begin;
+
+    while (end - ptr >= 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(inRange128(chars, '0', '9'))) & 0xFFFF;
+        if (stop) return (ptr - begin) + __builtin_ctz(stop);
+        ptr += 16;
+    }
+
+    return (ptr - begin) + scalarDigits(ptr, end);
+}
+
+#define AVX2_KERNEL __attribute__((target("avx2")))
+
+AVX2_KERNEL static inline __m256i inRange256(__m256i chars, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(chars, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(static_cast<char>(hi - lo))), shifted);
+}
+
+AVX2_KERNEL static inline __m256i whitespace256(__m256i chars) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), inRange256(chars, '\t', '\r'));
+}
+
+AVX2_KERNEL static inline __m256i identifier256(__m256i chars) {
+    __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(
+        _mm256_or_si256(inRange256(lower, 'a', 'z'), inRange256(chars, '0', '9')),
+        _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')));
+}
+
+AVX2_KERNEL static size_t avx2Whitespace(const char* begin, const char* end, uint32_t baseOffset, std::vector<uint32_t>& lineStarts) {
+    const char* ptr = begin;
+
+    while (end - ptr >= 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(whitespace256(chars)));
+        unsigned newlines = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')));
+        size_t count = stop ? __builtin_ctz(stop) : 32;
+
+        if (count < 32) newlines &= (1u << count) - 1;
+        size_t offset = ptr - begin;
+        recordNewlines(newlines, baseOffset + static_cast<uint32_t>(offset), lineStarts);
+
+        if (count < 32) return offset + count;
+        ptr += 32;
+    }
+
+    return (ptr - begin) + scalarWhitespace(ptr, end, baseOffset + static_cast<uint32_t>(ptr - begin), lineStarts);
+}
+
+AVX2_KERNEL static size_t avx2Identifier(const char* begin, const char* end) {
+    const char* ptr = begin;
+
+    while (end - ptr >= 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(identifier256(chars)));
+        if (stop) return (ptr - begin) + __builtin_ctz(stop);
+        ptr += 32;
+    }
+
+    return (ptr - begin) + sse2Identifier(ptr, end);
+}
+
+AVX2_KERNEL static size_t avx2Digits(const char* begin, const char* end) {
+    const char* ptr = begin;
+
+    while (end - ptr >= 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(inRange256(chars, '0', '9')));
+        if (stop) return (ptr - begin) + __builtin_ctz(stop);
+        ptr += 32;
+    }
+
+    return (ptr - begin) + sse2Digits(ptr, end);
+}
+
+#endif
+
+const ScanKernels& scalarScanKernels() {
+    static const ScanKernels kernels{"scalar", scalarWhitespace, scalarIdentifier, scalarDigits};
+    return kernels;
+}
+
+const ScanKernels* sse2ScanKernels() {
+#ifdef COMODOT_X86_KERNELS
+    static const ScanKernels kernels{"sse2", sse2Whitespace, sse2Identifier, sse2Digits};
+    return __builtin_cpu_supports("sse2") ? &kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const ScanKernels* avx2ScanKernels() {
+#ifdef COMODOT_X86_KERNELS
+    static const ScanKernels kernels{"avx2", avx2Whitespace, avx2Identifier, avx2Digits};
+    return __builtin_cpu_supports("avx2") ? &kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const ScanKernels& defaultScanKernels() {
+    static const ScanKernels* best = [] {
+        if (const ScanKernels* kernels = avx2ScanKernels()) return kernels;
+        if (const ScanKernels* kernels = sse2ScanKernels()) return kernels;
+        return &scalarScanKernels();
+    }();
+    return *best;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Character-class scanners behind the Lexer's hot loops. Every kernel returns
+// the length of the longest prefix of [begin, end) in its class and must agree
+// byte for byte with the scalar reference; the vector versions only change how
+// many bytes are classified per step.
+struct ScanKernels {
+    const char* name;
+    // isspace() bytes. For every newline in the run, appends the offset of the
+    // byte after it to lineStarts, where begin sits at baseOffset.
+    size_t (*whitespace)(const char* begin, const char* end, uint32_t baseOffset, std::vector<uint32_t>& lineStarts);
+    // isalnum() bytes and '_'.
+    size_t (*identifier)(const char* begin, const char* end);
+    // isdigit() bytes.
+    size_t (*digits)(const char* begin, const char* end);
+};
+
+const ScanKernels& scalarScanKernels();
+
+// nullptr when the build target or the running CPU lacks the instruction set.
+const ScanKernels* sse2ScanKernels();
+const ScanKernels* avx2ScanKernels();
+
+// AVX2 when the CPU has it, then SSE2, then the scalar reference.
+const ScanKernels& defaultScanKernels();
@@ -0,0 +1,115 @@
+#include "source_buffer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+SourceBuffer::SourceBuffer(std::string text)
+    : _mappedSize(0), _owned(std::make_unique<std::string>(std::move(text))) {
+    _data = _owned->data();
+    _size = _owned->size();
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept
+    : _data(other._data), _size(other._size), _mappedSize(other._mappedSize), _owned(std::move(other._owned)) {
+    other._data = nullptr;
+    other._size = 0;
+    other._mappedSize = 0;
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        _data = other._data;
+        _size = other._size;
+        _mappedSize = other._mappedSize;
+        _owned = std::move(other._owned);
+        other._data = nullptr;
+        other._size = 0;
+        other._mappedSize = 0;
+    }
+    return *this;
+}
+
+void SourceBuffer::release() {
+    if (_mappedSize != 0) {
+        munmap(const_cast<char*>(_data), _mappedSize);
+    }
+    _owned.reset();
+    _data = nullptr;
+    _size = 0;
+    _mappedSize = 0;
+}
+
+SourceBuffer SourceBuffer::borrow(std::string_view text) {
+    SourceBuffer buffer;
+    buffer._data = text.data();
+    buffer._size = text.size();
+    return buffer;
+}
+
+SourceBuffer SourceBuffer::fromFile(const std::string& path) {
+    if (path == "-") {
+        return fromDescriptor(STDIN_FILENO);
+    }
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw systemError("Cannot open " + path);
+    }
+
+    try {
+        SourceBuffer buffer = fromDescriptor(fd);
+        close(fd);
+        return buffer;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+SourceBuffer SourceBuffer::fromDescriptor(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        throw systemError("Cannot stat source descriptor");
+    }
+
+    if (S_ISREG(info.st_mode) && info.st_size > 0) {
+        size_t size = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, size, MADV_SEQUENTIAL);
+
+            SourceBuffer buffer;
+            buffer._data = static_cast<const char*>(mapped);
+            buffer._size = size;
+            buffer._mappedSize = size;
+            return buffer;
+        }
+    }
+
+    std::string text;
+    char chunk[1 << 16];
+
+    for (;;) {
+        ssize_t count = read(fd, chunk, sizeof(chunk));
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("Cannot read source");
+        }
+        if (count == 0) break;
+        text.append(chunk, static_cast<size_t>(count));
+    }
+
+    return SourceBuffer(std::move(text));
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Read-only source text handed to the Lexer. Regular files are memory-mapped so
+// the lexer reads the page cache directly; pipes, ttys and stdin fall back to
+// buffered reads into an owned string. The text never moves once the buffer is
+// built, so views into it survive moving the buffer (and the lexer) around.
+class SourceBuffer {
+    const char* _data;
+    size_t _size;
+    size_t _mappedSize;
+    std::unique_ptr<std::string> _owned;
+
+    void release();
+
+public:
+    SourceBuffer() : _data(nullptr), _size(0), _mappedSize(0) {}
+    explicit SourceBuffer(std::string text);
+
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer() { release(); }
+
+    // Opens path, or stdin when path is "-".
+    static SourceBuffer fromFile(const std::string& path);
+    // Maps fd when it refers to a regular file, otherwise reads it to the end.
+    // The descriptor is not closed.
+    static SourceBuffer fromDescriptor(int fd);
+
+    // Views text without owning it; the caller keeps it alive and unchanged.
+    static SourceBuffer borrow(std::string_view text);
+
+    bool isMapped() const { return _mappedSize != 0; }
+
+    std::string_view text() const { return std::string_view(_data, _size); }
+};
@@ -0,0 +1,235 @@
+#include "streaming_lexer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+static size_t readDescriptor(int fd, char* buffer, size_t capacity) {
+    for (;;) {
+        ssize_t count = read(fd, buffer, capacity);
+        if (count >= 0) {
+            return static_cast<size_t>(count);
+        }
+        if (errno != EINTR) {
+            throw std::runtime_error(std::string("Cannot read source: ") + std::strerror(errno));
+        }
+    }
+}
+
+StreamingLexer::StreamingLexer(Reader reader, size_t chunkSize, bool readAhead)
+    : reader(std::move(reader)), chunkSize(std::max<size_t>(chunkSize, 1)), consumedBytes(0), nextSerial(0),
+      produceIndex(0), inputFinished(false), rowsSoFar(1), lastLineStart(0), currentToken{0, Token::END_OF_FILE, {}, {}},
+      currentSerial(0), lookaheadHead(0), lookaheadSize(0), readAhead(readAhead), producerDone(false), stopping(false) {
+    if (readAhead) {
+        producer = std::thread(&StreamingLexer::produceChunks, this);
+    }
+}
+
+StreamingLexer::StreamingLexer(int fd, size_t chunkSize, bool readAhead)
+    : StreamingLexer([fd](char* buffer, size_t capacity) { return readDescriptor(fd, buffer, capacity); },
+                     chunkSize, readAhead) {}
+
+StreamingLexer::~StreamingLexer() {
+    if (producer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        producer.join();
+    }
+}
+
+void StreamingLexer::produceChunks() {
+    const size_t capacity = 2;
+
+    for (;;) {
+        std::string chunk(chunkSize, '\0');
+        try {
+            chunk.resize(reader(chunk.data(), chunk.size()));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            producerError = std::current_exception();
+            producerDone = true;
+            queueChanged.notify_all();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait(lock, [&] { return readyChunks.size() < capacity || stopping; });
+
+        if (stopping || chunk.empty()) {
+            producerDone = true;
+            queueChanged.notify_all();
+            return;
+        }
+
+        readyChunks.push_back(std::move(chunk));
+        queueChanged.notify_all();
+    }
+}
+
+std::string StreamingLexer::nextChunk() {
+    if (!readAhead) {
+        std::string chunk(chunkSize, '\0');
+        chunk.resize(reader(chunk.data(), chunk.size()));
+        return chunk;
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueChanged.wait(lock, [&] { return !readyChunks.empty() || producerDone; });
+
+    if (readyChunks.empty()) {
+        if (producerError) {
+            std::rethrow_exception(producerError);
+        }
+        return {};
+    }
+
+    std::string chunk = std::move(readyChunks.front());
+    readyChunks.pop_front();
+    queueChanged.notify_all();
+    return chunk;
+}
+
+// Builds the next segment: the carried partial token plus whole chunks, cut
+// after the last whitespace byte so that no token is split.
+void StreamingLexer::loadSegment() {
+    std::string text = std::move(carry);
+    carry.clear();
+
+    for (;;) {
+        std::string chunk = nextChunk();
+        if (chunk.empty()) {
+            inputFinished = true;
+            break;
+        }
+
+        size_t oldSize = text.size();
+        text += chunk;
+
+        size_t cut = text.size();
+        while (cut > oldSize && !isspace(static_cast<unsigned char>(text[cut - 1]))) {
+            cut--;
+        }
+        if (cut > oldSize) {
+            carry.assign(text, cut, std::string::npos);
+            text.resize(cut);
+            break;
+        }
+    }
+
+    if (consumedBytes + text.size() > UINT32_MAX) {
+        throw std::runtime_error("Source is too large to lex");
+    }
+
+    segments.emplace_back();
+    Segment& segment = segments.back();
+    segment.text = std::move(text);
+    segment.base = static_cast<uint32_t>(consumedBytes);
+    segment.serial = nextSerial++;
+    segment.firstRow = rowsSoFar;
+    segment.firstLineStart = lastLineStart;
+    consumedBytes += segment.text.size();
+
+    Lexer lexer(SourceBuffer::borrow(segment.text));
+    segment.tokens = lexer.tokenizeAll();
+    segment.tokenCount = segment.tokens.size() - (inputFinished ? 0 : 1);
+
+    const std::vector<uint32_t>& localLines = segment.tokens.lines().lineStarts();
+    for (size_t i = 1; i < localLines.size(); ++i) {
+        segment.lineStarts.push_back(segment.base + localLines[i]);
+    }
+    rowsSoFar += static_cast<int>(segment.lineStarts.size());
+    if (!segment.lineStarts.empty()) {
+        lastLineStart = segment.lineStarts.back();
+    }
+
+    for (const LexError& error : lexer.getErrors()) {
+        errors.push_back(LexError{segment.base + error.offset, error.message});
+    }
+
+    produceIndex = 0;
+}
+
+StreamingLexer::PendingToken StreamingLexer::pull() {
+    for (;;) {
+        if (!segments.empty() && produceIndex < segments.back().tokenCount) {
+            Segment& segment = segments.back();
+            Token token = segment.tokens.token(produceIndex++);
+            token.offset += segment.base;
+            return PendingToken{token, segment.serial};
+        }
+
+        if (inputFinished) {
+            uint64_t serial = segments.empty() ? 0 : segments.back().serial;
+            return PendingToken{Token{static_cast<uint32_t>(consumedBytes), Token::END_OF_FILE, {}, {}}, serial};
+        }
+
+        loadSegment();
+    }
+}
+
+void StreamingLexer::releaseConsumedSegments() {
+    while (segments.size() > 1 && segments.front().serial < currentSerial) {
+        segments.pop_front();
+    }
+}
+
+Token const& StreamingLexer::next() {
+    PendingToken pending;
+    if (lookaheadSize != 0) {
+        pending = lookahead[lookaheadHead];
+        lookaheadHead = (lookaheadHead + 1) & (maxLookahead - 1);
+        lookaheadSize--;
+    } else {
+        pending = pull();
+    }
+
+    currentToken = pending.token;
+    currentSerial = pending.serial;
+    releaseConsumedSegments();
+
+    return currentToken;
+}
+
+Token const& StreamingLexer::peek(size_t distance) {
+    if (distance == 0 || distance > maxLookahead) {
+        throw std::out_of_range("Lookahead distance out of range");
+    }
+
+    while (lookaheadSize < distance) {
+        lookahead[(lookaheadHead + lookaheadSize) & (maxLookahead - 1)] = pull();
+        lookaheadSize++;
+    }
+
+    return lookahead[(lookaheadHead + distance - 1) & (maxLookahead - 1)].token;
+}
+
+SourceLocation StreamingLexer::locate(uint32_t offset) const {
+    for (const Segment& segment : segments) {
+        if (offset < segment.base || offset > segment.base + segment.text.size()) {
+            continue;
+        }
+
+        auto line = std::upper_bound(segment.lineStarts.begin(), segment.lineStarts.end(), offset);
+        size_t linesBefore = line - segment.lineStarts.begin();
+        uint32_t lineStart = linesBefore == 0 ? segment.firstLineStart : segment.lineStarts[linesBefore - 1];
+
+        return SourceLocation{segment.firstRow + static_cast<int>(linesBefore), static_cast<int>(offset - lineStart) + 1};
+    }
+
+    throw std::out_of_range("Offset is no longer buffered");
+}
+
+size_t StreamingLexer::bufferedBytes() const {
+    size_t bytes = carry.size();
+    for (const Segment& segment : segments) {
+        bytes += segment.text.size();
+    }
+    return bytes;
+}
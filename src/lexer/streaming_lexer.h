@@ -0,0 +1,110 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lexer.h"
+
+// Lexes input that arrives in fixed-size chunks, e.g. generated code piped
+// into the compiler, without ever holding the whole program. Chunks are cut
+// back to their last whitespace byte and lexed as segments; tokens never span
+// whitespace, so a token straddling a chunk boundary simply moves into the
+// next segment. A segment is freed as soon as the token handed out by next()
+// comes from a later one, so memory is bounded by the chunk size and the
+// lookahead rather than by the input (a single whitespace-free run longer
+// than a chunk still has to be held in full).
+//
+// Offsets are global, as with Lexer. Token literals view the owning segment
+// and stay valid until the next call to next().
+class StreamingLexer {
+public:
+    // Fills up to capacity bytes and returns how many were written; 0 means
+    // the input is exhausted.
+    using Reader = std::function<size_t(char* buffer, size_t capacity)>;
+
+    static constexpr size_t maxLookahead = Lexer::maxLookahead;
+
+    // With readAhead, a producer thread keeps up to two chunks ready so
+    // reading overlaps with lexing.
+    explicit StreamingLexer(Reader reader, size_t chunkSize = 1 << 16, bool readAhead = true);
+    // Reads fd until end of file; the descriptor is not closed.
+    explicit StreamingLexer(int fd, size_t chunkSize = 1 << 16, bool readAhead = true);
+    ~StreamingLexer();
+
+    StreamingLexer(const StreamingLexer&) = delete;
+    StreamingLexer& operator=(const StreamingLexer&) = delete;
+
+    Token const& next();
+
+    // Same contract as Lexer::peek.
+    Token const& peek(size_t distance = 1);
+
+    // Same contract as Lexer::getErrors, with global offsets.
+    const std::vector<LexError>& getErrors() const { return errors; }
+
+    // Row and column of an offset inside a segment that is still held, i.e.
+    // the current token, the lookahead, or anything after them that was read.
+    SourceLocation locate(uint32_t offset) const;
+
+    // Source bytes currently held in segments and the partial-token carry.
+    size_t bufferedBytes() const;
+
+private:
+    struct Segment {
+        std::string text;
+        uint32_t base;
+        uint64_t serial;
+        TokenStream tokens;
+        // Tokens to hand out; a segment's END_OF_FILE only counts in the last.
+        size_t tokenCount;
+        int firstRow;
+        uint32_t firstLineStart;
+        std::vector<uint32_t> lineStarts;
+    };
+
+    struct PendingToken {
+        Token token;
+        uint64_t serial;
+    };
+
+    Reader reader;
+    size_t chunkSize;
+
+    std::deque<Segment> segments;
+    std::string carry;
+    uint64_t consumedBytes;
+    uint64_t nextSerial;
+    size_t produceIndex;
+    bool inputFinished;
+    int rowsSoFar;
+    uint32_t lastLineStart;
+
+    Token currentToken;
+    uint64_t currentSerial;
+    PendingToken lookahead[maxLookahead];
+    size_t lookaheadHead;
+    size_t lookaheadSize;
+
+    std::vector<LexError> errors;
+
+    bool readAhead;
+    std::thread producer;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<std::string> readyChunks;
+    bool producerDone;
+    bool stopping;
+    std::exception_ptr producerError;
+
+    void produceChunks();
+    std::string nextChunk();
+    void loadSegment();
+    PendingToken pull();
+    void releaseConsumedSegments();
+};
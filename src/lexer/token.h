@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+struct Token {
+    enum TokenType {
+        PLUS = 0,
+        MINUS,
+        SLASH,
+        STAR,
+        DOUBLE_EQ,
+        EQ,
+        LT,
+        GT,
+        LTE,
+        GTE,
+        NEQ,
+        DOT,
+        EXCLAMATION,
+        IDENTIFICATOR,
+
+        INTEGER,
+        FLOAT,
+        CHAR,
+        BOOL,
+
+        FUNC_LITERAL,
+        INT_TYPE,
+        FLOAT_TYPE,
+        CHAR_TYPE,
+        BOOL_TYPE,
+
+        L_CURL_BRACE,
+        R_CURL_BRACE,
+
+        L_BRACE,
+        R_BRACE,
+
+        SEMICOLON,
+        COMMA,
+
+        RETURN,
+
+        IF,
+        ELSE,
+
+        AND,
+        OR,
+
+        ARROW,
+
+        PUBLIC,
+        PRIVATE,
+
+        // Returned from then on once the input is exhausted.
+        END_OF_FILE,
+        // A byte that starts no token; the lexer records a LexError for it and
+        // carries on with the next byte.
+        INVALID
+    };
+
+    // Byte offset of the first character; Lexer::locate turns it into a row
+    // and column.
+    uint32_t offset;
+    TokenType tokenType;
+    // Points into the lexer's source buffer and stays valid for as long as the
+    // lexer is alive. Empty for punctuation, whose text is implied by tokenType.
+    std::string_view literal;
+    // Converted once by the lexer for INTEGER and FLOAT tokens, and the
+    // interned Symbol id of an IDENTIFICATOR; zero otherwise.
+    union {
+        int32_t intValue;
+        float floatValue;
+        uint32_t symbolId;
+    };
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../utilities/interner/string_interner.h"
+#include "line_table.h"
+#include "token.h"
+
+static_assert(Token::INVALID <= UINT8_MAX, "TokenStream stores token kinds in a byte");
+
+// Struct-of-arrays token buffer filled by Lexer::tokenizeAll. It always ends
+// with an END_OF_FILE token, so lookahead never needs a bounds check. The
+// arrays (kinds, offsets, literal lengths, numeric values) are walked
+// linearly by the parser; rows and columns come from the line table only
+// when a diagnostic asks.
+// Literals view the lexer's source buffer, so the stream must not outlive the
+// lexer that produced it.
+class TokenStream {
+    std::string_view _text;
+    std::vector<uint8_t> _kinds;
+    std::vector<uint32_t> _offsets;
+    std::vector<uint32_t> _lengths;
+    // Bit patterns of Token::intValue / Token::floatValue / Token::symbolId.
+    std::vector<uint32_t> _values;
+    LineTable _lines;
+
+    // Overwrites [first, last) of array with replacement, moving the tail at
+    // most once.
+    template <typename T>
+    static void spliceArray(std::vector<T>& array, size_t first, size_t last, const std::vector<T>& replacement) {
+        size_t removed = last - first;
+        if (replacement.size() > removed) {
+            array.insert(array.begin() + last, replacement.size() - removed, T());
+        } else {
+            array.erase(array.begin() + first + replacement.size(), array.begin() + last);
+        }
+        std::copy(replacement.begin(), replacement.end(), array.begin() + first);
+    }
+
+  public:
+    TokenStream() = default;
+    explicit TokenStream(std::string_view text) : _text(text) {}
+
+    void reserve(size_t count) {
+        _kinds.reserve(count);
+        _offsets.reserve(count);
+        _lengths.reserve(count);
+        _values.reserve(count);
+    }
+
+    void append(const Token& token) {
+        _kinds.push_back(static_cast<uint8_t>(token.tokenType));
+        _offsets.push_back(token.offset);
+        _lengths.push_back(static_cast<uint32_t>(token.literal.size()));
+
+        uint32_t bits;
+        std::memcpy(&bits, &token.intValue, sizeof(bits));
+        _values.push_back(bits);
+    }
+
+    void append(const TokenStream& other) {
+        _kinds.insert(_kinds.end(), other._kinds.begin(), other._kinds.end());
+        _offsets.insert(_offsets.end(), other._offsets.begin(), other._offsets.end());
+        _lengths.insert(_lengths.end(), other._lengths.begin(), other._lengths.end());
+        _values.insert(_values.end(), other._values.begin(), other._values.end());
+    }
+
+    // Replaces tokens [first, last) with replacement and moves every token
+    // after them by shift bytes (modulo 2^32, so negative shifts work).
+    void replaceRange(size_t first, size_t last, const TokenStream& replacement, uint32_t shift) {
+        for (size_t i = last; i < size(); ++i) {
+            _offsets[i] += shift;
+        }
+
+        spliceArray(_kinds, first, last, replacement._kinds);
+        spliceArray(_offsets, first, last, replacement._offsets);
+        spliceArray(_lengths, first, last, replacement._lengths);
+        spliceArray(_values, first, last, replacement._values);
+    }
+
+    // Points the literals at a new copy of the source, e.g. after an edit.
+    void setText(std::string_view text) { _text = text; }
+
+    void setLines(LineTable lines) { _lines = std::move(lines); }
+    LineTable& lines() { return _lines; }
+    const LineTable& lines() const { return _lines; }
+
+    size_t size() const { return _kinds.size(); }
+    bool empty() const { return _kinds.empty(); }
+
+    Token::TokenType kind(size_t index) const { return static_cast<Token::TokenType>(_kinds[index]); }
+    uint32_t offset(size_t index) const { return _offsets[index]; }
+    uint32_t length(size_t index) const { return _lengths[index]; }
+    int32_t intValue(size_t index) const { return static_cast<int32_t>(_values[index]); }
+    Symbol symbol(size_t index) const { return Symbol(_values[index]); }
+
+    float floatValue(size_t index) const {
+        float value;
+        std::memcpy(&value, &_values[index], sizeof(value));
+        return value;
+    }
+
+    SourceLocation location(size_t index) const { return _lines.locate(_offsets[index]); }
+
+    // Empty for punctuation, like Token::literal.
+    std::string_view literal(size_t index) const { return _text.substr(_offsets[index], _lengths[index]); }
+
+    Token token(size_t index) const {
+        Token token{offset(index), kind(index), literal(index), {}};
+        std::memcpy(&token.intValue, &_values[index], sizeof(token.intValue));
+        return token;
+    }
+
+    const std::vector<uint8_t>& kinds() const { return _kinds; }
+    const std::vector<uint32_t>& offsets() const { return _offsets; }
+
+    // Bytes held per token across all arrays, for comparing with sizeof(Token).
+    static constexpr size_t bytesPerToken() {
+        return sizeof(uint8_t) + 3 * sizeof(uint32_t);
+    }
+};
@@ -0,0 +1,261 @@
+#include "parser.h"
+
+struct InfixOperator {
+    int precedence;
+    BinaryOperator op;
+};
+
+// Binding power of each binary operator token; 0 ends an expression. All of
+// them are left-associative.
+static constexpr InfixOperator infixOperator(Token::TokenType type) {
+    switch (type) {
+        case Token::OR: return {1, OR};
+        case Token::AND: return {2, AND};
+        case Token::DOUBLE_EQ: return {3, EQ};
+        case Token::NEQ: return {3, NEQ};
+        case Token::LT: return {4, LT};
+        case Token::GT: return {4, GT};
+        case Token::LTE: return {4, LTE};
+        case Token::GTE: return {4, GTE};
+        case Token::PLUS: return {5, ADD};
+        case Token::MINUS: return {5, SUB};
+        case Token::STAR: return {6, MUL};
+        case Token::SLASH: return {6, DIV};
+        default: return {0, ADD};
+    }
+}
+
+static constexpr int prefixPrecedence = 7;
+
+static_assert(infixOperator(Token::STAR).precedence > infixOperator(Token::PLUS).precedence);
+static_assert(infixOperator(Token::AND).precedence > infixOperator(Token::OR).precedence);
+
+static const char* spelling(Token::TokenType type) {
+    switch (type) {
+        case Token::PLUS: return "'+'";
+        case Token::MINUS: return "'-'";
+        case Token::SLASH: return "'/'";
+        case Token::STAR: return "'*'";
+        case Token::DOUBLE_EQ: return "'=='";
+        case Token::EQ: return "'='";
+        case Token::LT: return "'<'";
+        case Token::GT: return "'>'";
+        case Token::LTE: return "'<='";
+        case Token::GTE: return "'>='";
+        case Token::NEQ: return "'!='";
+        case Token::DOT: return "'.'";
+        case Token::EXCLAMATION: return "'!'";
+        case Token::L_CURL_BRACE: return "'{'";
+        case Token::R_CURL_BRACE: return "'}'";
+        case Token::L_BRACE: return "'('";
+        case Token::R_BRACE: return "')'";
+        case Token::SEMICOLON: return "';'";
+        case Token::COMMA: return "','";
+        case Token::AND: return "'&&'";
+        case Token::OR: return "'||'";
+        case Token::ARROW: return "'->'";
+        case Token::END_OF_FILE: return "end of file";
+        default: return nullptr;
+    }
+}
+
+void Parser::fail(size_t index, const std::string& message) const {
+    SourceLocation location = _tokens.location(index);
+    throw ParseError(_tokens.offset(index),
+                     std::to_string(location.row) + ":" + std::to_string(location.col) + ": " + message);
+}
+
+bool Parser::match(Token::TokenType type) {
+    if (!check(type)) return false;
+    _position++;
+    return true;
+}
+
+void Parser::unexpected(const char* what) const {
+    const char* found = spelling(kind());
+    fail(_position, std::string("Expected ") + what + ", found " +
+                        (found ? found : "'" + std::string(_tokens.literal(_position)) + "'"));
+}
+
+size_t Parser::expect(Token::TokenType type, const char* what) {
+    if (!check(type)) {
+        unexpected(what);
+    }
+    return _position++;
+}
+
+Span<INode*> Parser::takePendingNodes(size_t first) {
+    Span<INode*> nodes = _arena.copy(_pendingNodes.data() + first, _pendingNodes.size() - first);
+    _pendingNodes.resize(first);
+    return nodes;
+}
+
+std::vector<FunctionNode*> Parser::parseProgram() {
+    std::vector<FunctionNode*> functions;
+    while (!check(Token::END_OF_FILE)) {
+        functions.push_back(parseFunction());
+    }
+    return functions;
+}
+
+FunctionNode* Parser::parseFunction() {
+    std::string_view visibility = "private";
+    if (match(Token::PUBLIC)) {
+        visibility = "public";
+    } else {
+        match(Token::PRIVATE);
+    }
+
+    expect(Token::FUNC_LITERAL, "'fn'");
+    Symbol functionName = name(expect(Token::IDENTIFICATOR, "function name"));
+
+    _pendingArgs.clear();
+    expect(Token::L_BRACE, "'('");
+    if (!check(Token::R_BRACE)) {
+        do {
+            Symbol argName = name(expect(Token::IDENTIFICATOR, "parameter name"));
+            _pendingArgs.emplace_back(argName, parseType());
+        } while (match(Token::COMMA));
+    }
+    expect(Token::R_BRACE, "')'");
+    auto args = _arena.copy(_pendingArgs);
+
+    Symbol retType = Symbol::intern("Void");
+    if (match(Token::ARROW)) {
+        retType = parseType();
+    }
+
+    BlockNode* body = parseBlock();
+    return _arena.make<FunctionNode>(functionName, retType, visibility, args, body);
+}
+
+Symbol Parser::parseType() {
+    switch (kind()) {
+        case Token::INT_TYPE:
+        case Token::FLOAT_TYPE:
+        case Token::CHAR_TYPE:
+        case Token::BOOL_TYPE:
+        case Token::IDENTIFICATOR:
+            return name(_position++);
+        default:
+            unexpected("type");
+    }
+}
+
+BlockNode* Parser::parseBlock() {
+    expect(Token::L_CURL_BRACE, "'{'");
+
+    size_t first = _pendingNodes.size();
+    while (!match(Token::R_CURL_BRACE)) {
+        if (check(Token::END_OF_FILE)) {
+            expect(Token::R_CURL_BRACE, "'}'");
+        }
+        INode* statement = parseStatement();
+        _pendingNodes.push_back(statement);
+    }
+
+    return _arena.make<BlockNode>(takePendingNodes(first));
+}
+
+INode* Parser::parseStatement() {
+    INode* statement = nullptr;
+
+    if (match(Token::RETURN)) {
+        INode* value = nullptr;
+        if (!check(Token::SEMICOLON)) {
+            value = parseExpression(1);
+        }
+        statement = _arena.make<ReturnNode>(value);
+    } else if (check(Token::IDENTIFICATOR) && kind(1) == Token::EQ) {
+        Symbol variable = name(_position);
+        _position += 2;
+        statement = _arena.make<VarDefNode>(variable, parseExpression(1));
+    } else if (check(Token::IF) || check(Token::ELSE)) {
+        fail(_position, "Conditionals are not supported yet");
+    } else {
+        statement = parseExpression(1);
+    }
+
+    expect(Token::SEMICOLON, "';'");
+    return statement;
+}
+
+INode* Parser::parseCall(std::optional<Symbol> alias, Symbol callee) {
+    size_t first = _pendingNodes.size();
+
+    expect(Token::L_BRACE, "'('");
+    if (!check(Token::R_BRACE)) {
+        do {
+            INode* arg = parseExpression(1);
+            _pendingNodes.push_back(arg);
+        } while (match(Token::COMMA));
+    }
+    expect(Token::R_BRACE, "')'");
+
+    return _arena.make<CallNode>(alias, callee, takePendingNodes(first));
+}
+
+INode* Parser::parsePrefix() {
+    size_t index = _position++;
+
+    switch (_tokens.kind(index)) {
+        case Token::INTEGER:
+            return _arena.make<IntegerNode>(_tokens.intValue(index));
+        case Token::FLOAT:
+            return _arena.make<FloatNode>(_tokens.floatValue(index));
+        case Token::BOOL:
+            return _arena.make<BooleanNode>(_tokens.literal(index) == "true");
+        case Token::IDENTIFICATOR: {
+            Symbol identifier = name(index);
+            if (check(Token::L_BRACE)) {
+                return parseCall(std::nullopt, identifier);
+            }
+            if (check(Token::DOT)) {
+                _position++;
+                Symbol member = name(expect(Token::IDENTIFICATOR, "function name"));
+                return parseCall(identifier, member);
+            }
+            return _arena.make<IdentifierNode>(identifier);
+        }
+        case Token::L_BRACE: {
+            INode* inner = parseExpression(1);
+            expect(Token::R_BRACE, "')'");
+            return inner;
+        }
+        case Token::MINUS:
+            if (check(Token::INTEGER)) {
+                return _arena.make<IntegerNode>(-_tokens.intValue(_position++));
+            }
+            if (check(Token::FLOAT)) {
+                return _arena.make<FloatNode>(-_tokens.floatValue(_position++));
+            }
+            return _arena.make<UnaryOperationNode>(parseExpression(prefixPrecedence), NEG);
+        case Token::EXCLAMATION:
+            return _arena.make<BinaryOperationNode>(parseExpression(prefixPrecedence),
+                                                    _arena.make<BooleanNode>(false), EQ);
+        default:
+            _position = index;
+            unexpected("expression");
+    }
+}
+
+INode* Parser::parseExpression(int minPrecedence) {
+    INode* lhs = parsePrefix();
+
+    for (;;) {
+        InfixOperator infix = infixOperator(kind());
+        if (infix.precedence < minPrecedence || infix.precedence == 0) {
+            return lhs;
+        }
+
+        _position++;
+        INode* rhs = parseExpression(infix.precedence + 1);
+        lhs = _arena.make<BinaryOperationNode>(lhs, rhs, infix.op);
+    }
+}
+
+INode* Parser::parseExpression() {
+    INode* expression = parseExpression(1);
+    expect(Token::END_OF_FILE, "end of expression");
+    return expression;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../ast/ast.h"
+#include "token_stream.h"
+
+class ParseError : public std::runtime_error {
+    uint32_t _offset;
+public:
+    ParseError(uint32_t offset, const std::string& message) : std::runtime_error(message), _offset(offset) {}
+
+    uint32_t getOffset() const { return _offset; }
+};
+
+// Recursive-descent parser over a lexed TokenStream, with a Pratt loop for
+// expressions. Tokens are read in place by index, so lookahead is free. Nodes
+// are allocated in the given arena and names are the Symbols the lexer
+// interned, so the tree does not depend on the source.
+//
+//   program   := function*
+//   function  := ["pub"] "fn" IDENT "(" [param {"," param}] ")" ["->" type] block
+//   param     := IDENT type
+//   block     := "{" statement* "}"
+//   statement := "ret" [expr] ";" | IDENT "=" expr ";" | expr ";"
+//
+// "-x" becomes a NEG unary node, and a negative literal is folded into the
+// literal. The AST has no other unary nodes and no conditionals: "!x"
+// becomes "x == false", and "if" is rejected.
+class Parser {
+    const TokenStream& _tokens;
+    Arena& _arena;
+    size_t _position;
+
+    // Children of the blocks and calls being parsed, innermost last; each list
+    // is copied into the arena once complete.
+    std::vector<INode*> _pendingNodes;
+    std::vector<std::tuple<Symbol, Symbol>> _pendingArgs;
+
+    Token::TokenType kind(size_t distance = 0) const { return _tokens.kind(_position + distance); }
+    bool check(Token::TokenType type) const { return kind() == type; }
+    bool match(Token::TokenType type);
+    size_t expect(Token::TokenType type, const char* what);
+    [[noreturn]] void fail(size_t index, const std::string& message) const;
+    [[noreturn]] void unexpected(const char* what) const;
+
+    // Identifiers arrive interned; type keywords are interned here.
+    Symbol name(size_t index) const {
+        return _tokens.kind(index) == Token::IDENTIFICATOR ? _tokens.symbol(index) : Symbol::intern(_tokens.literal(index));
+    }
+    Span<INode*> takePendingNodes(size_t first);
+
+    FunctionNode* parseFunction();
+    Symbol parseType();
+    BlockNode* parseBlock();
+    INode* parseStatement();
+    INode* parsePrefix();
+    INode* parseCall(std::optional<Symbol> alias, Symbol callee);
+    INode* parseExpression(int minPrecedence);
+
+public:
+    // tokens must end with END_OF_FILE, as Lexer::tokenizeAll leaves it.
+    Parser(const TokenStream& tokens, Arena& arena) : _tokens(tokens), _arena(arena), _position(0) {}
+
+    // Parses every function up to END_OF_FILE. Throws ParseError, whose
+    // message starts with the row and column, at the first syntax error.
+    std::vector<FunctionNode*> parseProgram();
+
+    // Parses a single expression that must span the rest of the stream.
+    INode* parseExpression();
+};
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "../itt/ast_to_itt_translator/ast_to_itt_translator.h"
+#include "lexer.h"
+#include "parser.h"
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// Functions shaped like the generated code we compile, eight lines each.
+static std::string generateSource(size_t targetBytes, size_t& lines) {
+    std::string source;
+    source.reserve(targetBytes + 512);
+    lines = 0;
+
+    for (size_t i = 0; source.size() < targetBytes; ++i) {
+        std::string id = std::to_string(i);
+        source += "pub fn generated_component_compute_" + id + "(input_value Int, scale Float) -> Int {\n";
+        source += "    scaled_value = input_value * " + id + " + 3.25 - component_offset_" + id + ";\n";
+        source += "    in_range = scaled_value >= 10 && scaled_value != " + id + " || !is_enabled_flag;\n";
+        source += "    adjusted = helpers.clamp(scaled_value / 2, -" + id + ", (input_value + 1) * scale);\n";
+        source += "    total = adjusted - generated_component_compute_" + id + "(input_value - 1, scale);\n";
+        source += "    ret total <= 0;\n";
+        source += "}\n\n";
+        lines += 8;
+    }
+
+    return source;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 16;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    size_t lines = 0;
+    std::string source = generateSource(megabytes << 20, lines);
+    double sizeMb = static_cast<double>(source.size()) / (1 << 20);
+
+    double bestLexSeconds = 1e100;
+    double bestParseSeconds = 1e100;
+    double bestTranslateSeconds = 1e100;
+    double bestFreeSeconds = 1e100;
+    size_t functions = 0;
+    size_t parseAllocations = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        Lexer lexer(source);
+        TokenStream tokens = lexer.tokenizeAll();
+        auto lexed = std::chrono::steady_clock::now();
+
+        size_t before = allocationCount.load();
+        auto arena = std::make_unique<Arena>();
+        auto program = Parser(tokens, *arena).parseProgram();
+        parseAllocations = allocationCount.load() - before;
+        functions = program.size();
+        auto parsed = std::chrono::steady_clock::now();
+
+        AstToIttTranslator translator(*arena);
+        for (const auto& function : program) {
+            translator.translate(*function);
+        }
+        auto translated = std::chrono::steady_clock::now();
+
+        arena.reset();
+        auto freed = std::chrono::steady_clock::now();
+
+        bestLexSeconds = std::min(bestLexSeconds, std::chrono::duration<double>(lexed - start).count());
+        bestParseSeconds = std::min(bestParseSeconds, std::chrono::duration<double>(parsed - lexed).count());
+        bestTranslateSeconds = std::min(bestTranslateSeconds, std::chrono::duration<double>(translated - parsed).count());
+        bestFreeSeconds = std::min(bestFreeSeconds, std::chrono::duration<double>(freed - translated).count());
+    }
+
+    std::cout << "input:          " << sizeMb << " MB, " << lines << " lines, " << functions << " functions\n";
+    std::cout << "parse:          " << lines / bestParseSeconds / 1e6 << " Mlines/s, "
+              << sizeMb / bestParseSeconds << " MB/s\n";
+    std::cout << "lex+parse:      " << lines / (bestLexSeconds + bestParseSeconds) / 1e6 << " Mlines/s, "
+              << sizeMb / (bestLexSeconds + bestParseSeconds) << " MB/s\n";
+    std::cout << "parse allocs:   " << parseAllocations << " (" << parseAllocations / lines << " per line)\n";
+    std::cout << "parse+translate:" << (bestParseSeconds + bestTranslateSeconds) * 1000 << " ms\n";
+    std::cout << "free AST:       " << bestFreeSeconds * 1000 << " ms\n";
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include "../itt/ast_to_itt_translator/ast_to_itt_translator.h"
+#include "lexer.h"
+#include "parser.h"
+
+// Renders an expression fully parenthesized, so tests can state the expected
+// grouping directly.
+class ExpressionPrinter : public IVisitor {
+    std::string _out;
+public:
+    std::string print(INode& node) {
+        node.accept(*this);
+        return _out;
+    }
+
+    void visit(IntegerNode& node) override { _out += std::to_string(node.getValue()); }
+    void visit(FloatNode& node) override { _out += std::to_string(node.getValue()); }
+    void visit(BooleanNode& node) override { _out += node.getValue() ? "true" : "false"; }
+    void visit(IdentifierNode& node) override { _out += node.getName().str(); }
+
+    void visit(BinaryOperationNode& node) override {
+        static const char* spellings[] = {"-", "/", "+", "*", "&&", "||", "<", ">", "<=", ">=", "==", "!="};
+        _out += "(";
+        node.getLhs().accept(*this);
+        _out += std::string(" ") + spellings[node.getOp()] + " ";
+        node.getRhs().accept(*this);
+        _out += ")";
+    }
+
+    void visit(UnaryOperationNode& node) override {
+        _out += "(-";
+        node.getOperand().accept(*this);
+        _out += ")";
+    }
+
+    void visit(CallNode& node) override {
+        if (node.getAlias()) _out += std::string(node.getAlias()->str()) + ".";
+        _out += std::string(node.getName().str()) + "(";
+        for (size_t i = 0; i < node.getArgs().size(); ++i) {
+            if (i != 0) _out += ", ";
+            node.getArgs()[i]->accept(*this);
+        }
+        _out += ")";
+    }
+
+    void visit(VarDefNode&) override {}
+    void visit(ReturnNode&) override {}
+    void visit(BlockNode&) override {}
+    void visit(FunctionNode&) override {}
+};
+
+static std::string parseAndPrint(const std::string& source) {
+    Lexer lexer(source);
+    TokenStream tokens = lexer.tokenizeAll();
+    Arena arena;
+    Parser parser(tokens, arena);
+    ExpressionPrinter printer;
+    return printer.print(*parser.parseExpression());
+}
+
+TEST(ParserTest, ArithmeticPrecedenceTest) {
+    ASSERT_EQ(parseAndPrint("1 + 2 * 3 - 4"), "((1 + (2 * 3)) - 4)");
+    ASSERT_EQ(parseAndPrint("a - b - c"), "((a - b) - c)");
+    ASSERT_EQ(parseAndPrint("a / b * c"), "((a / b) * c)");
+    ASSERT_EQ(parseAndPrint("(1 + 2) * 3"), "((1 + 2) * 3)");
+}
+
+TEST(ParserTest, LogicalPrecedenceTest) {
+    ASSERT_EQ(parseAndPrint("a < b && c >= d || e"), "(((a < b) && (c >= d)) || e)");
+    ASSERT_EQ(parseAndPrint("a || b && c"), "(a || (b && c))");
+    ASSERT_EQ(parseAndPrint("a + 1 == b * 2 != c"), "(((a + 1) == (b * 2)) != c)");
+    ASSERT_EQ(parseAndPrint("a <= b > c"), "((a <= b) > c)");
+}
+
+TEST(ParserTest, UnaryOperatorsTest) {
+    ASSERT_EQ(parseAndPrint("-3 * x"), "(-3 * x)");
+    ASSERT_EQ(parseAndPrint("-x * 2"), "((-x) * 2)");
+    ASSERT_EQ(parseAndPrint("a - -b"), "(a - (-b))");
+    ASSERT_EQ(parseAndPrint("-(a + 1.5)"), "(-(a + 1.500000))");
+    ASSERT_EQ(parseAndPrint("!a && b"), "((a == false) && b)");
+    ASSERT_EQ(parseAndPrint("!(a || true)"), "((a || true) == false)");
+}
+
+TEST(ParserTest, FloatNegationTest) {
+    Lexer lexer("fn neg(x Float) -> Float { ret -x; }");
+    TokenStream tokens = lexer.tokenizeAll();
+    Arena arena;
+    auto functions = Parser(tokens, arena).parseProgram();
+
+    BlockNode& body = functions[0]->getBody();
+    auto& ret = dynamic_cast<ReturnNode&>(*body.getNodes()[0]);
+    auto& negation = dynamic_cast<UnaryOperationNode&>(**ret.getRetData());
+    EXPECT_EQ(negation.getOp(), NEG);
+    EXPECT_EQ(dynamic_cast<IdentifierNode&>(negation.getOperand()).getName(), "x");
+
+    // Negation is not a subtraction from an Int zero, so it translates to a
+    // node of its own.
+    AstToIttTranslator translator(arena);
+    auto& function = static_cast<IttFunctionNode&>(*translator.translate(*functions[0]));
+    auto& itt = static_cast<IttReturnNode&>(*static_cast<IttBlockNode&>(function.getBody()).getStatements()[0]);
+    EXPECT_EQ((*itt.getReturnStmt())->getKind(), IttKind::UNARY_OPERATION);
+}
+
+TEST(ParserTest, CallsTest) {
+    ASSERT_EQ(parseAndPrint("f(1, g(2)) + m.h()"), "(f(1, g(2)) + m.h())");
+    ASSERT_EQ(parseAndPrint("f() * 2"), "(f() * 2)");
+}
+
+TEST(ParserTest, FunctionTest) {
+    Lexer lexer("pub fn add(a Int, b Float) -> Int {\n    c = a + b;\n    ret c;\n}\n\nfn noop() { ret; }");
+    TokenStream tokens = lexer.tokenizeAll();
+    Arena arena;
+    auto functions = Parser(tokens, arena).parseProgram();
+
+    ASSERT_EQ(functions.size(), 2u);
+
+    FunctionNode& add = *functions[0];
+    EXPECT_EQ(add.getName(), "add");
+    EXPECT_EQ(add.getVisibility(), "public");
+    EXPECT_EQ(add.getReturnType(), "Int");
+    ASSERT_EQ(add.getArgs().size(), 2u);
+    EXPECT_EQ(std::get<0>(add.getArgs()[1]), "b");
+    EXPECT_EQ(std::get<1>(add.getArgs()[1]), "Float");
+
+    const auto& statements = add.getBody().getNodes();
+    ASSERT_EQ(statements.size(), 2u);
+    auto* def = dynamic_cast<VarDefNode*>(statements[0]);
+    ASSERT_NE(def, nullptr);
+    EXPECT_EQ(def->getName(), "c");
+    auto* ret = dynamic_cast<ReturnNode*>(statements[1]);
+    ASSERT_NE(ret, nullptr);
+    ASSERT_TRUE(ret->getRetData().has_value());
+
+    FunctionNode& noop = *functions[1];
+    EXPECT_EQ(noop.getVisibility(), "private");
+    EXPECT_EQ(noop.getReturnType(), "Void");
+    ASSERT_EQ(noop.getBody().getNodes().size(), 1u);
+    EXPECT_FALSE(dynamic_cast<ReturnNode&>(*noop.getBody().getNodes()[0]).getRetData().has_value());
+}
+
+TEST(ParserTest, ParsedProgramTranslatesTest) {
+    Lexer lexer("fn f(x Int) -> Int { y = x * 2 + 1; ret y >= 3 && true; }");
+    TokenStream tokens = lexer.tokenizeAll();
+    Arena arena;
+    auto functions = Parser(tokens, arena).parseProgram();
+
+    AstToIttTranslator translator(arena);
+    auto result = translator.translate(*functions[0]);
+    auto* function = dynamic_cast<IttFunctionNode*>(result);
+    ASSERT_NE(function, nullptr);
+
+    auto& body = dynamic_cast<IttBlockNode&>(function->getBody());
+    ASSERT_EQ(body.getStatements().size(), 2u);
+    auto& ret = dynamic_cast<IttReturnNode&>(*body.getStatements()[1]);
+    auto& condition = dynamic_cast<IttBinaryOperationNode&>(**ret.getReturnStmt());
+    EXPECT_EQ(condition.getOperation(), IttBinaryOperation::AND);
+    EXPECT_EQ(dynamic_cast<IttBinaryOperationNode&>(condition.getLhs()).getOperation(),
+              IttBinaryOperation::GREATER_EQUALS);
+    EXPECT_TRUE(condition.getRhs() == IttBooleanNode(true));
+}
+
+TEST(ParserTest, TreeOutlivesSourceTest) {
+    Arena arena;
+    std::vector<FunctionNode*> functions;
+    {
+        Lexer lexer("fn first(value Int) -> Int { ret value; }");
+        TokenStream tokens = lexer.tokenizeAll();
+        functions = Parser(tokens, arena).parseProgram();
+    }
+
+    EXPECT_EQ(functions[0]->getName(), "first");
+    EXPECT_EQ(std::get<0>(functions[0]->getArgs()[0]), "value");
+    EXPECT_EQ(std::get<1>(functions[0]->getArgs()[0]), "Int");
+}
+
+static std::string parseError(const std::string& source) {
+    Lexer lexer(source);
+    TokenStream tokens = lexer.tokenizeAll();
+    Arena arena;
+    try {
+        Parser(tokens, arena).parseProgram();
+    } catch (const ParseError& error) {
+        return error.what();
+    }
+    return "";
+}
+
+TEST(ParserTest, SyntaxErrorsTest) {
+    EXPECT_EQ(parseError("fn f( {}"), "1:7: Expected parameter name, found '{'");
+    EXPECT_EQ(parseError("fn f() {\n  x = ;\n}"), "2:7: Expected expression, found ';'");
+    EXPECT_EQ(parseError("fn f() { ret 1 }"), "1:16: Expected ';', found '}'");
+    EXPECT_EQ(parseError("fn f() { ret 1;"), "1:16: Expected '}', found end of file");
+    EXPECT_EQ(parseError("fn f(a) {}"), "1:7: Expected type, found ')'");
+    EXPECT_EQ(parseError("fn f() { x @ 1; }"), "1:12: Expected ';', found '@'");
+    EXPECT_EQ(parseError("fn f() { if x {} }"), "1:10: Conditionals are not supported yet");
+}
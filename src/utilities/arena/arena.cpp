@@ -0,0 +1,13 @@
+#include "arena.h"
+
+#include <algorithm>
+
+void* Arena::allocateSlow(size_t size, size_t alignment) {
+    size_t blockSize = std::max(_nextBlockSize, size + alignment);
+    _blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+    _nextBlockSize = blockSize * 2;
+
+    _cursor = _blocks.back().get();
+    _end = _cursor + blockSize;
+    return allocate(size, alignment);
+}
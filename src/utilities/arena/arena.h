@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A view of count consecutive objects inside an Arena.
+template <typename T>
+class Span {
+    T* _data;
+    uint32_t _size;
+public:
+    Span() : _data(nullptr), _size(0) {}
+    Span(T* data, uint32_t size) : _data(data), _size(size) {}
+
+    T* begin() const { return _data; }
+    T* end() const { return _data + _size; }
+    uint32_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    T& operator[](size_t index) const { return _data[index]; }
+};
+
+// Bump allocator for objects that die together, such as one compilation's
+// AST. Nothing is destroyed individually: objects must be trivially
+// destructible and are released all at once with the arena, in a handful of
+// frees of geometrically growing blocks.
+class Arena {
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    char* _cursor;
+    char* _end;
+    size_t _nextBlockSize;
+    size_t _bytesUsed;
+
+    void* allocateSlow(size_t size, size_t alignment);
+
+    void reset() {
+        _blocks.clear();
+        _cursor = nullptr;
+        _end = nullptr;
+        _bytesUsed = 0;
+    }
+
+public:
+    explicit Arena(size_t firstBlockSize = 64 << 10)
+        : _cursor(nullptr), _end(nullptr), _nextBlockSize(firstBlockSize), _bytesUsed(0) {}
+
+    // The source is left empty, not pointing into blocks it no longer owns.
+    Arena(Arena&& other) noexcept
+        : _blocks(std::move(other._blocks)), _cursor(other._cursor), _end(other._end),
+          _nextBlockSize(other._nextBlockSize), _bytesUsed(other._bytesUsed) {
+        other.reset();
+    }
+
+    Arena& operator=(Arena&& other) noexcept {
+        if (this != &other) {
+            _blocks = std::move(other._blocks);
+            _cursor = other._cursor;
+            _end = other._end;
+            _nextBlockSize = other._nextBlockSize;
+            _bytesUsed = other._bytesUsed;
+            other.reset();
+        }
+        return *this;
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment) {
+        uintptr_t cursor = reinterpret_cast<uintptr_t>(_cursor);
+        uintptr_t aligned = (cursor + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        if (_cursor == nullptr || aligned + size > reinterpret_cast<uintptr_t>(_end)) {
+            return allocateSlow(size, alignment);
+        }
+
+        _cursor = reinterpret_cast<char*>(aligned + size);
+        _bytesUsed += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    Span<T> copy(const T* items, size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+        if (count == 0) return {};
+
+        T* data = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        std::uninitialized_copy(items, items + count, data);
+        return Span<T>(data, static_cast<uint32_t>(count));
+    }
+
+    template <typename T>
+    Span<T> copy(const std::vector<T>& items) { return copy(items.data(), items.size()); }
+
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) return {};
+
+        char* data = static_cast<char*>(allocate(text.size(), 1));
+        memcpy(data, text.data(), text.size());
+        return std::string_view(data, text.size());
+    }
+
+    size_t bytesUsed() const { return _bytesUsed; }
+    size_t blockCount() const { return _blocks.size(); }
+};
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "arena.h"
+
+struct Pair {
+    int32_t first;
+    double second;
+};
+
+TEST(ArenaTest, AlignmentTest) {
+    Arena arena(64);
+
+    for (int i = 0; i < 1000; ++i) {
+        arena.allocate(1, 1);
+        Pair* pair = arena.make<Pair>(Pair{i, i * 0.5});
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(pair) % alignof(Pair), 0u);
+        ASSERT_EQ(pair->first, i);
+    }
+
+    ASSERT_LT(arena.blockCount(), 16u);
+}
+
+TEST(ArenaTest, CopyTest) {
+    Arena arena;
+
+    std::string name = "identifier";
+    std::string_view copied = arena.copy(std::string_view(name));
+    name[0] = 'X';
+    ASSERT_EQ(copied, "identifier");
+
+    std::vector<int> values = {1, 2, 3};
+    Span<int> span = arena.copy(values);
+    values.clear();
+    ASSERT_EQ(span.size(), 3u);
+    ASSERT_EQ(span[2], 3);
+
+    ASSERT_TRUE(arena.copy(std::vector<int>()).empty());
+}
+
+TEST(ArenaTest, OversizedAllocationTest) {
+    Arena arena(16);
+    char* big = static_cast<char*>(arena.allocate(1 << 20, 1));
+    big[(1 << 20) - 1] = 'x';
+    ASSERT_EQ(arena.bytesUsed(), 1u << 20);
+}
+
+TEST(ArenaTest, MoveTest) {
+    Arena source(64);
+    int* kept = source.make<int>(7);
+
+    Arena moved(std::move(source));
+    ASSERT_EQ(source.blockCount(), 0u);
+    ASSERT_EQ(source.bytesUsed(), 0u);
+
+    // The source allocates a block of its own rather than writing into the
+    // one it gave away.
+    int* fresh = source.make<int>(8);
+    ASSERT_EQ(*kept, 7);
+    ASSERT_EQ(*fresh, 8);
+    ASSERT_EQ(source.blockCount(), 1u);
+
+    Arena assigned;
+    assigned = std::move(moved);
+    ASSERT_EQ(moved.blockCount(), 0u);
+    ASSERT_EQ(assigned.bytesUsed(), sizeof(int));
+    assigned.make<int>(9);
+    ASSERT_EQ(*kept, 7);
+}
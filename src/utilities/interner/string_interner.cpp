@@ -0,0 +1,89 @@
+#include "string_interner.h"
+
+#include <cstring>
+
+StringInterner& StringInterner::getInstance() {
+    static StringInterner instance;
+    return instance;
+}
+
+StringInterner::StringInterner() : _size(0) {
+    for (auto& chunk : _chunks) chunk.store(nullptr, std::memory_order_relaxed);
+    append(std::string_view());
+    _ids.emplace(std::string_view(), 0);
+}
+
+// Called with the mutex held, or from the constructor. The name is written
+// before the chunk and the size are published, so a reader that was handed
+// its id sees it.
+void StringInterner::append(std::string_view stored) {
+    uint32_t id = _size.load(std::memory_order_relaxed);
+    size_t chunk = chunkOf(id);
+    std::string_view* names = _chunks[chunk].load(std::memory_order_relaxed);
+    if (!names) {
+        size_t capacity = size_t(1) << (firstChunkBits + chunk);
+        names = static_cast<std::string_view*>(
+            _storage.allocate(capacity * sizeof(std::string_view), alignof(std::string_view)));
+        _chunks[chunk].store(names, std::memory_order_release);
+    }
+    new (&names[indexIn(id, chunk)]) std::string_view(stored);
+    _size.store(id + 1, std::memory_order_release);
+}
+
+// Interned text never moves or dies, so a thread can remember recent hits
+// without the lock; the shared table is only consulted on a cache miss.
+struct CachedSymbol {
+    const char* data;
+    uint32_t size;
+    uint32_t id;
+};
+
+static constexpr size_t cacheSize = 4096;
+static thread_local CachedSymbol cache[cacheSize];
+
+// Cheap cache index from the length and the first and last eight bytes;
+// generated names tend to share a prefix and differ at the end.
+static size_t cacheIndex(std::string_view text) {
+    if (text.empty()) return 0;
+
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    if (text.size() >= 8) {
+        memcpy(&head, text.data(), 8);
+        memcpy(&tail, text.data() + text.size() - 8, 8);
+    } else {
+        memcpy(&head, text.data(), text.size());
+    }
+
+    uint64_t mixed = (head ^ (tail * 0x9E3779B97F4A7C15ull) ^ text.size()) * 0xFF51AFD7ED558CCDull;
+    return (mixed >> 52) & (cacheSize - 1);
+}
+
+Symbol StringInterner::intern(std::string_view text) {
+    if (text.empty()) return Symbol();
+
+    CachedSymbol& cached = cache[cacheIndex(text)];
+    if (cached.data && cached.size == text.size() && memcmp(cached.data, text.data(), text.size()) == 0) {
+        return Symbol(cached.id);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto found = _ids.find(text);
+    if (found == _ids.end()) {
+        std::string_view stored = _storage.copy(text);
+        found = _ids.emplace(stored, _size.load(std::memory_order_relaxed)).first;
+        append(stored);
+    }
+
+    cached = CachedSymbol{found->first.data(), static_cast<uint32_t>(text.size()), found->second};
+    return Symbol(found->second);
+}
+
+std::string_view StringInterner::lookup(Symbol symbol) {
+    uint32_t id = symbol.getId();
+    size_t chunk = chunkOf(id);
+    return _chunks[chunk].load(std::memory_order_acquire)[indexIn(id, chunk)];
+}
+
+size_t StringInterner::size() { return _size.load(std::memory_order_acquire); }
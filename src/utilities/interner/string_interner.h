@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../arena/arena.h"
+
+// A name interned by StringInterner. Equal names have equal symbols, so
+// comparing and hashing names is a single integer operation. The default
+// symbol is the empty string.
+class Symbol {
+    uint32_t _id;
+public:
+    constexpr Symbol() : _id(0) {}
+    constexpr explicit Symbol(uint32_t id) : _id(id) {}
+
+    // Shorthand for StringInterner::getInstance().intern(text).
+    static Symbol intern(std::string_view text);
+
+    uint32_t getId() const { return _id; }
+    bool empty() const { return _id == 0; }
+
+    // The interned text; stays valid for the life of the process.
+    std::string_view str() const;
+
+    bool operator==(Symbol other) const { return _id == other._id; }
+    bool operator!=(Symbol other) const { return _id != other._id; }
+    bool operator<(Symbol other) const { return _id < other._id; }
+
+    // Compares the text; meant for tests and diagnostics, not hot paths.
+    bool operator==(std::string_view text) const { return str() == text; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, Symbol symbol) { return out << symbol.str(); }
+
+template <>
+struct std::hash<Symbol> {
+    size_t operator()(Symbol symbol) const { return symbol.getId(); }
+};
+
+// Process-wide table of every distinct name the frontend has seen, each
+// stored once. Safe to use from the parallel lexer's worker threads.
+//
+// Names are only ever appended, so lookup takes no lock: the table of names
+// by id is a fixed array of chunks, each twice the size of the one before,
+// and a chunk never moves once published. Only intern's map from text to id
+// is behind the mutex.
+class StringInterner {
+  public:
+    static StringInterner& getInstance();
+
+    Symbol intern(std::string_view text);
+    std::string_view lookup(Symbol symbol);
+
+    size_t size();
+
+  private:
+    StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    static constexpr uint32_t firstChunkBits = 10;
+    static constexpr size_t chunkCount = 33 - firstChunkBits;
+
+    // Chunk of id and id's index within it; chunk c holds
+    // 2^(firstChunkBits + c) names.
+    static size_t chunkOf(uint32_t id) {
+        uint64_t position = (uint64_t(id) >> firstChunkBits) + 1;
+        return 63 - __builtin_clzll(position);
+    }
+    static size_t indexIn(uint32_t id, size_t chunk) {
+        return id - ((uint64_t(1) << (firstChunkBits + chunk)) - (uint64_t(1) << firstChunkBits));
+    }
+
+    void append(std::string_view stored);
+
+    std::mutex _mutex;
+    Arena _storage;
+    std::unordered_map<std::string_view, uint32_t> _ids;
+    std::atomic<std::string_view*> _chunks[chunkCount];
+    std::atomic<uint32_t> _size;
+};
+
+inline Symbol Symbol::intern(std::string_view text) { return StringInterner::getInstance().intern(text); }
+
+inline std::string_view Symbol::str() const { return StringInterner::getInstance().lookup(*this); }
@@ -0,0 +1,70 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+#include "string_interner.h"
+
+TEST(StringInternerTest, SameTextSameSymbolTest) {
+    std::string first = "interned_name";
+    std::string second = "interned_name";
+
+    Symbol a = Symbol::intern(first);
+    Symbol b = Symbol::intern(second);
+    ASSERT_EQ(a, b);
+    ASSERT_NE(a, Symbol::intern("other_name"));
+
+    first[0] = 'X';
+    ASSERT_EQ(a.str(), "interned_name");
+}
+
+TEST(StringInternerTest, EmptySymbolTest) {
+    ASSERT_EQ(Symbol::intern(""), Symbol());
+    ASSERT_TRUE(Symbol().empty());
+    ASSERT_EQ(Symbol().str(), "");
+}
+
+TEST(StringInternerTest, ConcurrentInterningTest) {
+    const int names = 2000;
+    std::vector<Symbol> results[4];
+
+    std::vector<std::thread> threads;
+    for (auto& result : results) {
+        threads.emplace_back([&result] {
+            for (int i = 0; i < names; ++i) {
+                result.push_back(Symbol::intern("concurrent_" + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < names; ++i) {
+        ASSERT_EQ(results[0][i], results[3][i]);
+        ASSERT_EQ(results[1][i].str(), "concurrent_" + std::to_string(i));
+    }
+}
+
+TEST(StringInternerTest, LookupWhileGrowingTest) {
+    // Enough names to fill several chunks of the id table while other
+    // threads read what they interned.
+    const int names = 20000;
+    std::vector<std::thread> threads;
+    std::atomic<bool> mismatch(false);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t, &mismatch] {
+            for (int i = 0; i < names; ++i) {
+                std::string text = "growing_" + std::to_string(t) + "_" + std::to_string(i);
+                if (Symbol::intern(text).str() != text) mismatch = true;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_FALSE(mismatch);
+    ASSERT_EQ(Symbol::intern("growing_0_0").str(), "growing_0_0");
+    ASSERT_EQ(Symbol::intern("growing_3_19999").str(), "growing_3_19999");
+}